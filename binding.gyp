@@ -5,20 +5,47 @@
             "sources": [
                 "src/nexpress.cc",
                 "src/application.cc",
+                "src/bodyChunk.cc",
+                "src/bodyEncoder.cc",
+                "src/byteRange.cc",
+                "src/compressionMiddleware.cc",
+                "src/connectionHandOff.cc",
                 "src/embeddedHttp.cc",
+                "src/fileSender.cc",
+                "src/headerCache.cc",
+                "src/http2Connection.cc",
                 "src/httpConnection.cc",
+                "src/ioWorker.cc",
+                "src/jsStrings.cc",
+                "src/loopContext.cc",
                 "src/middleware.cc",
+                "src/outputBatch.cc",
                 "src/pathRegexp.cc",
+                "src/readBufferAllocator.cc",
+                "src/regexRouteIndex.cc",
+                "src/receiveBuffer.cc",
                 "src/request.cc",
+                "src/requestHeaders.cc",
                 "src/response.cc",
+                "src/routeCache.cc",
                 "src/router.cc",
+                "src/routeTree.cc",
+                "src/staticFileCache.cc",
+                "src/staticMiddleware.cc",
+                "src/timerWheel.cc",
                 "src/next.cc",
+                "src/writeScheduler.cc",
                 "src/pathRegexp.cc",
                 "deps/picohttpparser/picohttpparser.c",
             ],
             "include_dirs" : [
                 "deps/uvw",
-                "deps/picohttpparser"
+                "deps/picohttpparser",
+                "deps/node/deps/brotli/c/include",
+                "deps/node/deps/nghttp2/lib/includes"
+            ],
+            "defines": [
+                "NGHTTP2_STATICLIB"
             ],
             "cflags_cc": [
                 "-std=c++17",
@@ -7,13 +7,14 @@ app.set('keepAlive', true);
 var apiRouter = nexpress.Router();
 
 apiRouter.post('/echo', function (req, res, next) {
-    req.rawBody = '';
+    var chunks = [];
 
     req.on('data', function(chunk) {
-        req.rawBody += chunk;
+        chunks.push(chunk);
     });
 
     req.on('end', function() {
+        req.rawBody = Buffer.concat(chunks).toString();
         next();
     });
 }, function (req, res) {
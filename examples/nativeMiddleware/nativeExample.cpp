@@ -17,3 +17,8 @@ extern "C" void emit(
 extern "C" bool isErrorHandling() {
     return false;
 }
+
+// Touches no JS objects, so it may also run on I/O threads
+extern "C" bool isThreadSafe() {
+    return true;
+}
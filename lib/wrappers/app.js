@@ -1,5 +1,6 @@
 'use strict';
 
+const path = require('path');
 const nexpressCore = require('../../build/Release/nexpress');
 const Router = require('./router');
 const {getNativeMiddlewareLoader} = require('./middleware');
@@ -21,6 +22,14 @@ Application.prototype.close = function() {
     this.__instance.close();
 }
 
+Application.prototype.routeCacheStats = function() {
+    return this.__instance.routeCacheStats();
+}
+
+Application.prototype.regexStats = function() {
+    return this.__instance.regexStats();
+}
+
 Application.prototype.set = function(settingName, settingValue) {
     if (typeof settingName !== 'string')
         throw new Error('Setting name must be string');
@@ -38,4 +47,15 @@ createApplication.Router = function() {
 
 createApplication.NativeMiddleware = getNativeMiddlewareLoader(nexpressCore.NativeMiddlewareWrap);
 
+createApplication.compression = function(options) {
+    return nexpressCore.compression(options || {});
+};
+
+createApplication.static = function(root, options) {
+    if (typeof root !== 'string')
+        throw new Error('Static root must be string');
+
+    return nexpressCore.static(path.resolve(root), options || {});
+};
+
 module.exports = createApplication;
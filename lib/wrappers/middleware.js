@@ -8,6 +8,38 @@ function getNativeMiddlewareLoader(nativeMiddlewareInternal) {
     }
 }
 
+/**
+ * Runs handlers of one route in a row, calling into the native pipeline only
+ * when the chain is left through next('route'), an error or its end.
+ */
+function runChain(chain, req, res, nextObj) {
+    let index = 0;
+
+    function next(str) {
+        if (typeof str === 'undefined') {
+            if (++index < chain.length && !nextObj.finished) {
+                invoke();
+            } else {
+                nextObj.next();
+            }
+        } else if (str === 'route') {
+            nextObj.nextRoute();
+        } else if (typeof str === 'object') {
+            nextObj.error(str.toString());
+        }
+    }
+
+    function invoke() {
+        try {
+            chain[index](req, res, next);
+        } catch (e) {
+            nextObj.error(e.toString());
+        }
+    }
+
+    invoke();
+}
+
 function middlewareWrapper(middleware) {
     if (middleware.length < 4 && middleware.length > 1) {
         function wrapped(req, res, nextObj) {
@@ -29,6 +61,8 @@ function middlewareWrapper(middleware) {
         }
 
         wrapped.isErrorHandling = false;
+        wrapped.handler = middleware;
+        wrapped.runChain = runChain;
 
         return wrapped;
     }
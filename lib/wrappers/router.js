@@ -11,7 +11,7 @@ function Router(internalRouterInstance) {
 Router.prototype.__isNexpressRouter = true;
 
 Router.prototype.use = function () {
-    const {path, keys} = getRegexAndKeys(arguments[0]);
+    const {path, keys, pattern} = getRegexAndKeys(arguments[0]);
 
     let i = 0;
     let middlewares = [];
@@ -24,7 +24,7 @@ Router.prototype.use = function () {
         middlewares.push(wrapIfNeeded(arguments[i]));
     }
 
-    this.__instance.use(null, true, path, keys, ...middlewares);
+    this.__instance.use(null, true, path, keys, pattern, ...middlewares);
 
     return this;
 }
@@ -51,6 +51,7 @@ function getRegexAndKeys(p) {
         return {
             path: null,
             keys: null,
+            pattern: null,
         };
     }
 
@@ -69,12 +70,12 @@ function getRegexAndKeys(p) {
         keys = null;
     }
 
-    return {path, keys};
+    return {path, keys, pattern: p};
 }
 
 function getMethod(method) {
     return function() {
-        const {path, keys} = getRegexAndKeys(arguments[0]);
+        const {path, keys, pattern} = getRegexAndKeys(arguments[0]);
 
         if (path === null) {
             return this;
@@ -86,7 +87,7 @@ function getMethod(method) {
             middlewares.push(wrapIfNeeded(arguments[i]));
         }
 
-        this.__instance.use(method, false, path, keys, ...middlewares);
+        this.__instance.use(method, false, path, keys, pattern, ...middlewares);
     }
 }
 
@@ -1,37 +1,120 @@
 #include "httpConnection.h"
 
+#include <unistd.h>
+
+#include "connectionHandOff.h"
+
 namespace nex {
 
     HttpConnection::HttpConnection(
-            std::shared_ptr<uvw::Loop> eventLoop,
+            std::shared_ptr<LoopContext> loopContext,
             v8::Isolate* isolate,
             std::shared_ptr<uvw::TCPHandle> clientHandle,
             std::shared_ptr<AbstractRequestProcessor> requestProc,
             std::shared_ptr<HttpServerConfig> configuration
     ) :
-            loop(std::move(eventLoop)),
+            context(std::move(loopContext)),
+            loop(context->getLoop()),
             client(std::move(clientHandle)),
             config(std::move(configuration)),
             requestProcessor(std::move(requestProc)),
-            isolate(isolate)
+            isolate(isolate),
+            receiveBuffer(context->getReadBufferAllocator())
     {
         startKeepAliveTimer();
+        attachClient();
+    }
 
+    void HttpConnection::attachClient() {
         client->data(thisRef);
 
         client->on<uvw::CloseEvent>(handleClose);
         client->on<uvw::ErrorEvent>(handleClientError);
         client->on<uvw::EndEvent>(handleDataEnd);
-        client->on<uvw::DataEvent>(handleData);
         client->on<uvw::ShutdownEvent>(handleShutdown);
     }
 
+    void HttpConnection::startReading() {
+        // Reads bypass uvw's DataEvent so that libuv fills the receive buffer directly
+        reading = true;
+        uv_read_start(reinterpret_cast<uv_stream_t*>(client->raw()), handleReadAlloc, handleRead);
+    }
+
+    void HttpConnection::stopReading() {
+        reading = false;
+        client->stop();
+    }
+
+    void HttpConnection::scheduleFlush() {
+        if (output.empty()) {
+            return;
+        }
+
+        if (
+            !config->coalesceWrites
+            || output.byteLength() >= config->maxCoalescedWriteSize
+            || output.bufferCount() >= maxCoalescedBuffers
+        ) {
+            flush();
+            return;
+        }
+
+        context->getWriteScheduler().schedule(this);
+    }
+
+    void HttpConnection::flush() {
+        context->getWriteScheduler().cancel(this);
+
+        if (output.empty()) {
+            return;
+        }
+
+        if (!client || closing) {
+            output.clear();
+            return;
+        }
+
+        // libuv reports write errors only to the write callback, a dead peer has to close the connection
+        output.submit(reinterpret_cast<uv_stream_t*>(client->raw()), [this](int status) {
+            handleWriteError(status);
+        });
+    }
+
+    void HttpConnection::handleWriteError(int status) {
+        // Pending writes are cancelled when the connection closes, nothing to do then
+        if (!status || status == UV_ECANCELED || !client || closing || shuttingDown || handingOff)
+            return;
+
+        handleClientError(uvw::ErrorEvent{status}, *client);
+    }
+
+    void HttpConnection::flush(std::function<void(int)> onWritten) {
+        context->getWriteScheduler().cancel(this);
+
+        if (!client || closing) {
+            output.clear();
+            onWritten(UV_ECANCELED);
+            return;
+        }
+
+        output.submit(reinterpret_cast<uv_stream_t*>(client->raw()), std::move(onWritten));
+    }
+
     void HttpConnection::close() {
-        closeTimeouts();
+        stopTimers();
 
-        if (closing || shuttingDown)
+        if (closing || shuttingDown || handingOff)
             return;
 
+        // GOAWAY goes out with the rest of the output
+        if (http2)
+            http2->terminate();
+
+        // Corked output has to be queued before the shutdown request, a failure no longer matters here
+        context->getWriteScheduler().cancel(this);
+        if (!output.empty() && client)
+            output.submit(reinterpret_cast<uv_stream_t*>(client->raw()));
+
         if (request)
             request->invalidate();
         if (response)
@@ -52,7 +135,8 @@ namespace nex {
     }
 
     void HttpConnection::eliminate() {
-        if (!requestTimeout && !responseTimeout && !keepAliveTimeout && !client) {
+        if (!client) {
+            context->getWriteScheduler().cancel(this);
             delete this;
         }
     }
@@ -77,149 +161,161 @@ namespace nex {
         processNextRequest();
     }
 
-    void HttpConnection::parseHeaders(
+    HeaderParseStatus HttpConnection::parseHeaders(
             const char* buffer,
             uint32_t bufferStart,
             uint32_t bufferLength,
-            std::vector<phr_header>& headers,
-            std::string& path,
+            uint32_t previousBufferLength,
+            phr_header* headers,
+            size_t& headersCount,
+            std::string_view& path,
             HttpMethod& method,
             uint32_t& minorVersion,
             uint32_t& bodyStart
     ) {
         const char *httpMethod, *uriPath;
         int parseStatus, httpVersion;
-        phr_header headersRaw[100];
-        size_t previousBufferLength = 0, methodLength,
-                pathLength, headersCount = 100;
+        size_t methodLength, pathLength;
 
+        // With a non-zero previous length the parser only scans new bytes for the end of the headers
         parseStatus = phr_parse_request(
                 buffer + bufferStart, bufferLength, &httpMethod, &methodLength,
-                &uriPath, &pathLength, &httpVersion, headersRaw, &headersCount,
+                &uriPath, &pathLength, &httpVersion, headers, &headersCount,
                 previousBufferLength
         );
 
-        if (parseStatus > 0) {
-            bodyStart = static_cast<uint32_t>(parseStatus);
-            minorVersion = static_cast<uint32_t>(httpVersion);
-            path = std::string(uriPath, pathLength);
-            headers = std::vector<phr_header>(headersRaw, headersRaw + headersCount);
+        if (parseStatus == -1) {
+            return HeaderParseStatus::Invalid;
+        }
 
-            try {
-                method = parseMethod(std::string(httpMethod, methodLength));
-            } catch (const std::runtime_error&) {
-                throw UnknownHTTPMethodError();
-            }
+        if (parseStatus == -2) {
+            if (bufferLength > 1024 * 16)
+                return HeaderParseStatus::TooLarge;
+            return HeaderParseStatus::Incomplete;
+        }
 
-            if (minorVersion != 0 && minorVersion != 1) {
-                throw HttpVersionUnsupportedError();
-            }
+        bodyStart = static_cast<uint32_t>(parseStatus);
+        minorVersion = static_cast<uint32_t>(httpVersion);
+        path = std::string_view(uriPath, pathLength);
 
-            return;
-        } else if (parseStatus == -1) {
-            throw ParseError();
-        } else if (parseStatus == -2) {
-            if (bufferLength - bufferStart > 1024 * 16)
-                throw RequestHeadersTooLargeError();
-            throw NeedMoreDataError();
+        if (!tryParseMethod(std::string_view(httpMethod, methodLength), method)) {
+            return HeaderParseStatus::UnknownMethod;
         }
+
+        if (minorVersion != 0 && minorVersion != 1) {
+            return HeaderParseStatus::UnsupportedVersion;
+        }
+
+        return HeaderParseStatus::Complete;
     }
 
-    void HttpConnection::parseRequest(const std::string& buffer, uint32_t& bufferPosition) {
+    bool HttpConnection::parseRequest(const char* buffer, uint32_t bufferLength, uint32_t& bufferPosition) {
         std::shared_ptr<Request> req;
-        std::vector<phr_header> rawHeaders;
-        std::string path;
+        phr_header rawHeaders[maxHeadersCount];
+        size_t headersCount = maxHeadersCount;
+        std::string_view path;
         HttpMethod method;
         uint32_t bodyStart = 0, minorVersion = 1;
+        uint32_t errorCode;
 
-        ++requestsAccepted;
-        try {
-            parseHeaders(
-                buffer.data(),
-                bufferPosition,
-                buffer.length() - bufferPosition,
-                rawHeaders,
-                path,
-                method,
-                minorVersion,
-                bodyStart
-            );
-        } catch (const ParseError&) {
-            req = createRequest(400, minorVersion);
-            requestQueue.push(std::move(req));
-
-            throw std::exception();
-        } catch (const RequestHeadersTooLargeError&) {
-            req = createRequest(413, minorVersion);
-            requestQueue.push(std::move(req));
-
-            throw std::exception();
-        } catch (const NeedMoreDataError &) {
-            needMoreDataToParseHeaders = true;
-            if (bufferPosition < buffer.length()) {
-                headerBuffer = std::string(buffer.begin() + bufferPosition, buffer.end());
-                bufferPosition = buffer.length();
-            }
+        auto previousLength = parsedHeaderLength;
+        parsedHeaderLength = 0;
 
-            return;
-        } catch (const UnknownHTTPMethodError &) {
-            req = createRequest(405, minorVersion);
-            requestQueue.push(std::move(req));
+        ++requestsAccepted;
 
-            throw std::exception();
-        } catch (const HttpVersionUnsupportedError &) {
-            req = createRequest(505, 1);
-            requestQueue.push(std::move(req));
+        switch (parseHeaders(
+            buffer,
+            bufferPosition,
+            bufferLength - bufferPosition,
+            previousLength,
+            rawHeaders,
+            headersCount,
+            path,
+            method,
+            minorVersion,
+            bodyStart
+        )) {
+            case HeaderParseStatus::Complete:
+                errorCode = 0;
+                break;
+            case HeaderParseStatus::Incomplete:
+                // Unparsed bytes stay in the receive buffer, the next attempt resumes where this one stopped
+                needMoreDataToParseHeaders = true;
+                parsedHeaderLength = bufferLength - bufferPosition;
+                --requestsAccepted;
+
+                return true;
+            case HeaderParseStatus::Invalid:
+                errorCode = 400;
+                break;
+            case HeaderParseStatus::TooLarge:
+                errorCode = 413;
+                break;
+            case HeaderParseStatus::UnknownMethod:
+                errorCode = 405;
+                break;
+            case HeaderParseStatus::UnsupportedVersion:
+                errorCode = 505;
+                minorVersion = 1;
+                break;
+        }
 
-            throw std::exception();
-        } catch (const std::exception&) {
-            req = createRequest(500, minorVersion);
+        if (errorCode) {
+            req = createRequest(errorCode, minorVersion);
             requestQueue.push(std::move(req));
 
-            throw std::exception();
+            return false;
         }
 
+        req = createRequest(
+            std::string_view(buffer + bufferPosition, bodyStart),
+            rawHeaders,
+            headersCount,
+            path,
+            method,
+            minorVersion
+        );
         bufferPosition += bodyStart;
 
-        req = createRequest(rawHeaders, path, method, minorVersion);
-
         if (path.length() > config->maxPathLength) {
             req->requestError = 414;
         }
 
-        auto contentLengthRaw = std::get_if<std::string>(&req->headers["Content-Length"]);
-        if (!contentLengthRaw) {
+        if (!req->headers.has(KnownHeader::ContentLength)) {
             req->isFullData = true;
             requestQueue.push(std::move(req));
 
-            return;
+            return true;
         }
 
-        uint32_t contentLength;
+        uint64_t contentLength;
+        auto contentLengthRaw = req->headers.get(KnownHeader::ContentLength);
+        auto contentLengthEnd = contentLengthRaw.data() + contentLengthRaw.length();
+        auto [contentLengthParsed, error] = std::from_chars(contentLengthRaw.data(), contentLengthEnd, contentLength);
 
-        try {
-            contentLength = std::stoll(*contentLengthRaw);
-        } catch (const std::exception&) {
+        if (error != std::errc() || contentLengthParsed != contentLengthEnd) {
             req->requestError = 411;
             requestQueue.push(std::move(req));
 
-            throw std::exception();
+            return false;
         }
 
         if (contentLength > config->maxRequestBodyLength) {
             req->requestError = 413;
             requestQueue.push(std::move(req));
 
-            throw std::exception();
+            return false;
         }
 
-        req->contentLength = contentLength;
+        req->contentLength = static_cast<uint32_t>(contentLength);
         requestQueue.push(std::move(req));
 
-        updateRequestBodyBuffer(buffer, bufferPosition);
+        updateRequestBodyBuffer(buffer, bufferLength, bufferPosition);
+
+        return true;
     }
 
-    void HttpConnection::updateRequestBodyBuffer(const std::string& buffer, uint32_t& bufferPosition) {
+    void HttpConnection::updateRequestBodyBuffer(const char* buffer, uint32_t bufferLength, uint32_t& bufferPosition) {
         std::shared_ptr<Request> req;
 
         if (!requestQueue.empty()) {
@@ -228,21 +324,15 @@ namespace nex {
             req = request;
         } else {
             // Pass data if request ignored data receive and is completed
-            auto bytesReceived = std::min(lastContentLeft, static_cast<uint32_t>(buffer.length() - bufferPosition));
-            bufferPosition += lastContentLeft;
+            auto bytesReceived = std::min(lastContentLeft, bufferLength - bufferPosition);
+            bufferPosition += bytesReceived;
             lastContentLeft -= bytesReceived;
             return;
         }
 
         auto contentLeft = req->contentLength - req->bodyOctetsReceived;
-        auto data = std::string(
-            buffer.begin() + bufferPosition,
-            buffer.begin() + std::min(
-                bufferPosition + contentLeft,
-                static_cast<uint32_t>(buffer.length())
-            )
-        );
-        auto bytesReceived = data.length();
+        auto bytesReceived = std::min(contentLeft, bufferLength - bufferPosition);
+        auto data = std::string_view(buffer + bufferPosition, bytesReceived);
         bufferPosition += bytesReceived;
         lastContentLeft = contentLeft - bytesReceived;
 
@@ -256,7 +346,7 @@ namespace nex {
     }
 
     void HttpConnection::processNextRequest() {
-        if (hasActiveRequest) {
+        if (hasActiveRequest || handingOff) {
             return;
         }
 
@@ -265,6 +355,11 @@ namespace nex {
             return;
         }
 
+        if (context->getHandOff() && requiresIsolate(*requestQueue.front())) {
+            handOff();
+            return;
+        }
+
         request = std::move(requestQueue.front());
         requestQueue.pop();
         response = createResponse(request);
@@ -280,39 +375,104 @@ namespace nex {
         requestProcessor->process(request, response);
     }
 
-    void HttpConnection::handleData(const uvw::DataEvent &data, uvw::TCPHandle &client) {
+    void HttpConnection::handleReadAlloc(uv_handle_t* handle, size_t, uv_buf_t* buf) {
+        auto& client = *static_cast<uvw::TCPHandle*>(handle->data);
+        auto httpConnection = getConnection(client);
+
+        *buf = httpConnection->receiveBuffer.prepare();
+    }
+
+    void HttpConnection::handleRead(uv_stream_t* handle, ssize_t bytesRead, const uv_buf_t*) {
+        auto& client = *static_cast<uvw::TCPHandle*>(handle->data);
         auto httpConnection = getConnection(client);
-        auto buffer = httpConnection->headerBuffer + std::string(data.data.get(), data.length);
+
+        // bytesRead == 0 is equivalent to EAGAIN, see http://docs.libuv.org/en/v1.x/stream.html
+        if (bytesRead == UV_EOF) {
+            // libuv stops reading by itself on EOF
+            httpConnection->reading = false;
+            handleDataEnd(uvw::EndEvent{}, client);
+        } else if (bytesRead > 0) {
+            httpConnection->receiveBuffer.commit(static_cast<size_t>(bytesRead));
+            handleData(client);
+        } else if (bytesRead < 0) {
+            handleClientError(uvw::ErrorEvent{bytesRead}, client);
+        }
+
+        // The shared scratch buffer is only valid until the read callback returns
+        httpConnection->receiveBuffer.retain();
+    }
+
+    void HttpConnection::handleData(uvw::TCPHandle &client) {
+        auto httpConnection = getConnection(client);
+        auto& receiveBuffer = httpConnection->receiveBuffer;
+        auto buffer = receiveBuffer.data();
+        auto bufferLength = static_cast<uint32_t>(receiveBuffer.size());
         uint32_t bufferPos = 0;
 
-        httpConnection->headerBuffer.clear();
         httpConnection->needMoreDataToParseHeaders = false;
 
         httpConnection->stopKeepAliveTimer();
         httpConnection->stopRequestTimer();
 
+        if (httpConnection->acceptsHttp2()) {
+            switch (Http2Connection::matchPreface(std::string_view(buffer, bufferLength))) {
+                case PrefaceMatch::Partial:
+                    // Times out like incomplete HTTP/1 headers would
+                    httpConnection->needMoreDataToParseHeaders = true;
+                    httpConnection->startRequestTimer();
+                    return;
+                case PrefaceMatch::Complete:
+                    if (!httpConnection->startHttp2()) {
+                        return;
+                    }
+                    break;
+                case PrefaceMatch::None:
+                    break;
+            }
+        }
+
+        if (httpConnection->http2) {
+            httpConnection->receiveHttp2();
+            return;
+        }
+
         if (httpConnection->needMoreDataToGetBody) {
             httpConnection->needMoreDataToGetBody = false;
 
-            httpConnection->updateRequestBodyBuffer(buffer, bufferPos);
+            httpConnection->updateRequestBodyBuffer(buffer, bufferLength, bufferPos);
         }
 
-        while (bufferPos < buffer.length()) {
+        while (bufferPos < bufferLength) {
+            bool accepted;
+
             try {
-                httpConnection->parseRequest(buffer, bufferPos);
+                accepted = httpConnection->parseRequest(buffer, bufferLength, bufferPos);
             } catch (const std::exception&) {
-                client.stop();
+                accepted = false;
+            }
+
+            if (!accepted) {
+                httpConnection->stopReading();
+                bufferPos = bufferLength;
                 break;
             }
-            if (httpConnection->isRequestLimitExceeded()) {
+
+            if (httpConnection->needMoreDataToParseHeaders || httpConnection->isRequestLimitExceeded()) {
                 break;
             }
         }
 
+        receiveBuffer.consume(bufferPos);
+
         httpConnection->processNextRequest();
 
+        // The connection belongs to another loop now, its timers must not be armed on this one
+        if (httpConnection->handingOff) {
+            return;
+        }
+
         if (httpConnection->isRequestLimitExceeded() && !httpConnection->needMoreDataToGetBody) {
-            client.stop();
+            httpConnection->stopReading();
         }
 
         if (httpConnection->needMoreDataToGetBody || httpConnection->needMoreDataToParseHeaders) {
@@ -320,42 +480,20 @@ namespace nex {
         }
     }
 
-    void HttpConnection::packHeaders(
-            const std::vector<phr_header>& rawHeaders,
-            const std::shared_ptr<Request>& req
-    ) {
-        std::string name, value;
-
-        for (const auto & rawHeader : rawHeaders) {
-            if (rawHeader.name != nullptr) {
-                if (rawHeader.value == nullptr)
-                    continue;
-
-                name = std::string(rawHeader.name, rawHeader.name_len);
-                value = std::string(rawHeader.value, rawHeader.value_len);
-
-                req->appendHeader(name, std::move(value));
-            } else if (rawHeader.value != nullptr) {
-                value = std::string(rawHeader.value, rawHeader.value_len);
-
-                if (!name.empty()) {
-                    req->appendHeader(name, std::move(value));
-                }
-            }
-        }
-    }
-
     std::shared_ptr<Request> HttpConnection::createRequest(
-            const std::vector<phr_header>& headers,
-            const std::string& path,
+            std::string_view headerBlock,
+            const phr_header* headers,
+            size_t headersCount,
+            std::string_view path,
             HttpMethod method,
             uint32_t minorVersion
     ) {
         auto req = std::shared_ptr<Request>(
-                new Request(thisRef, isolate, method, path, minorVersion)
+                new Request(thisRef, isolate, method, std::string(path), minorVersion)
         );
 
-        packHeaders(headers, req);
+        // The receive buffer is reused, so the request keeps its own copy of the header block
+        req->headers.assign(headerBlock, headers, headersCount);
 
         return req;
     }
@@ -386,6 +524,50 @@ namespace nex {
         return requestsAccepted > 0;
     }
 
+    bool HttpConnection::acceptsHttp2() const noexcept {
+        return config->http2
+            && !http2
+            && requestsAccepted == 0
+            && !hasActiveRequest
+            && !needMoreDataToGetBody
+            && requestQueue.empty();
+    }
+
+    bool HttpConnection::startHttp2() {
+        // Streams may call into JS at any time, the session is served on the isolate loop
+        if (context->getHandOff()) {
+            handOff();
+            return false;
+        }
+
+        try {
+            http2 = std::make_unique<Http2Connection>(*this);
+        } catch (const std::exception&) {
+            stopReading();
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void HttpConnection::receiveHttp2() {
+        auto data = std::string_view(receiveBuffer.data(), receiveBuffer.size());
+        auto received = http2->receive(data);
+
+        receiveBuffer.consume(data.length());
+
+        if (!received) {
+            stopReading();
+            close();
+            return;
+        }
+
+        if (active && !http2->hasActiveStreams()) {
+            startKeepAliveTimer();
+        }
+    }
+
     void HttpConnection::handleClientError(const uvw::ErrorEvent &err, uvw::TCPHandle &client) {
         auto httpConnection = getConnection(client);
         if (httpConnection->hasActiveRequest) {
@@ -425,76 +607,153 @@ namespace nex {
 
         httpConnection->closing = false;
         httpConnection->client.reset();
+
+        if (httpConnection->handingOff) {
+            auto handOff = httpConnection->context->getHandOff();
+
+            // Nothing of this loop may be referenced once the connection is posted
+            httpConnection->context.reset();
+            httpConnection->loop.reset();
+
+            handOff->post(httpConnection.get(), httpConnection->handOffSocket);
+            return;
+        }
+
         httpConnection->eliminate();
     }
 
-    void HttpConnection::startRequestTimer() {
-        if (!config->requestTimeout) {
-            return;
+    bool HttpConnection::requiresIsolate(const Request& req) const {
+        if (req.requestError) {
+            return false;
         }
 
-        if (!requestTimeout) {
-            requestTimeout = loop->resource<uvw::TimerHandle>();
-            requestTimeout->data(thisRef);
+        return requestProcessor->requiresIsolate(req.method, req.pathWithoutQueryString, context->getRouteCache());
+    }
+
+    void HttpConnection::handOff() {
+        handingOff = true;
+
+        stopTimers();
 
-            requestTimeout->on<uvw::TimerEvent>(handleRequestTimeout);
-            requestTimeout->once<uvw::CloseEvent>(handleRequestTimeoutClose);
+        if (reading) {
+            uv_read_stop(reinterpret_cast<uv_stream_t*>(client->raw()));
         }
 
-        requestTimeout->start(Time(config->requestTimeout),Time(0));
+        flush();
+        completeHandOff();
     }
 
-    void HttpConnection::startResponseTimer() {
-        if (!config->responseTimeout) {
+    void HttpConnection::completeHandOff() {
+        auto stream = reinterpret_cast<uv_stream_t*>(client->raw());
+        uv_os_fd_t fd;
+
+        // Queued output has to reach the kernel before the socket leaves this loop
+        if (uv_stream_get_write_queue_size(stream) > 0) {
+            context->getTimerWheel().arm(handOffTimer, 0);
             return;
         }
 
-        if (!responseTimeout) {
-            responseTimeout = loop->resource<uvw::TimerHandle>();
-            responseTimeout->data(thisRef);
+        if (uv_fileno(reinterpret_cast<uv_handle_t*>(stream), &fd) || (handOffSocket = dup(fd)) < 0) {
+            handingOff = false;
+            shuttingDown = false;
+            close();
+            return;
+        }
+
+        pendingInput = receiveBuffer.detach();
+        context->getWriteScheduler().cancel(this);
+        stopTimers();
 
-            responseTimeout->on<uvw::TimerEvent>(handleResponseTimeout);
-            responseTimeout->once<uvw::CloseEvent>(handleResponseTimeoutClose);
+        closing = true;
+        client->close();
+    }
+
+    void HttpConnection::adopt(
+            std::shared_ptr<LoopContext> loopContext,
+            std::shared_ptr<uvw::TCPHandle> clientHandle,
+            uv_os_sock_t socket
+    ) {
+        context = std::move(loopContext);
+        loop = context->getLoop();
+        client = std::move(clientHandle);
+        handingOff = false;
+
+        attachClient();
+        client->open(socket);
+
+        if (closing || shuttingDown) {
+            return;
         }
 
-        responseTimeout->start(Time(config->responseTimeout),Time(0));
+        receiveBuffer.attach(context->getReadBufferAllocator(), pendingInput);
+        pendingInput = std::string();
+
+        if (reading) {
+            startReading();
+        }
+
+        if (!receiveBuffer.empty()) {
+            handleData(*client);
+            return;
+        }
+
+        processNextRequest();
+
+        if (needMoreDataToGetBody) {
+            startRequestTimer();
+        }
     }
 
-    void HttpConnection::startKeepAliveTimer() {
-        if (!config->keepAliveTimeout || !config->persistentConnections) {
+    void HttpConnection::handleHandOffRetry(TimerEntry& timer) {
+        timer.getData<HttpConnection>()->completeHandOff();
+    }
+
+    void HttpConnection::startRequestTimer() {
+        if (!config->requestTimeout) {
             return;
         }
 
-        if (!keepAliveTimeout) {
-            keepAliveTimeout = loop->resource<uvw::TimerHandle>();
-            keepAliveTimeout->data(thisRef);
+        context->getTimerWheel().arm(requestTimer, config->requestTimeout);
+    }
 
-            keepAliveTimeout->on<uvw::TimerEvent>(handleKeepAliveTimeout);
-            keepAliveTimeout->once<uvw::CloseEvent>(handleKeepAliveTimeoutClose);
+    void HttpConnection::startResponseTimer() {
+        if (!config->responseTimeout) {
+            return;
+        }
+
+        context->getTimerWheel().arm(responseTimer, config->responseTimeout);
+    }
+
+    void HttpConnection::startKeepAliveTimer() {
+        if (!config->keepAliveTimeout || !config->persistentConnections) {
+            return;
         }
 
-        keepAliveTimeout->start(Time(config->keepAliveTimeout),Time(0));
+        context->getTimerWheel().arm(keepAliveTimer, config->keepAliveTimeout);
     }
 
     void HttpConnection::stopRequestTimer() {
-        if (requestTimeout && !requestTimeoutClosing)
-            requestTimeout->stop();
+        context->getTimerWheel().disarm(requestTimer);
     }
 
     void HttpConnection::stopResponseTimer() {
-        if (responseTimeout && !responseTimeoutClosing)
-            responseTimeout->stop();
+        context->getTimerWheel().disarm(responseTimer);
     }
 
     void HttpConnection::stopKeepAliveTimer() {
-        if (keepAliveTimeout && !keepAliveTimeoutClosing)
-            keepAliveTimeout->stop();
+        context->getTimerWheel().disarm(keepAliveTimer);
     }
 
-    void HttpConnection::handleRequestTimeout(const uvw::TimerEvent&, uvw::TimerHandle& timer) {
-        auto httpConnection = getConnection(timer);
+    void HttpConnection::stopTimers() noexcept {
+        stopRequestTimer();
+        stopResponseTimer();
+        stopKeepAliveTimer();
+    }
 
-        httpConnection->client->stop();
+    void HttpConnection::handleRequestTimeout(TimerEntry& timer) {
+        auto httpConnection = timer.getData<HttpConnection>();
+
+        httpConnection->stopReading();
         if (httpConnection->needMoreDataToParseHeaders) {
             auto req = httpConnection->createRequest(408);
             httpConnection->requestQueue.push(req);
@@ -525,8 +784,8 @@ namespace nex {
         }
     }
 
-    void HttpConnection::handleResponseTimeout(const uvw::TimerEvent&, uvw::TimerHandle& timer) {
-        auto httpConnection = getConnection(timer);
+    void HttpConnection::handleResponseTimeout(TimerEntry& timer) {
+        auto httpConnection = timer.getData<HttpConnection>();
 
         if (!httpConnection->response) {
             return;
@@ -536,56 +795,19 @@ namespace nex {
         httpConnection->response->end();
     }
 
-    void HttpConnection::handleKeepAliveTimeout(const uvw::TimerEvent&, uvw::TimerHandle& timer) {
-        auto httpConnection = getConnection(timer);
+    void HttpConnection::handleKeepAliveTimeout(TimerEntry& timer) {
+        auto httpConnection = timer.getData<HttpConnection>();
 
-        httpConnection->client->stop();
-        if (httpConnection->hasActiveRequest || !httpConnection->requestQueue.empty()) {
+        if (httpConnection->http2 && httpConnection->http2->hasActiveStreams()) {
             return;
         }
 
-        httpConnection->close();
-    }
-
-    void HttpConnection::handleRequestTimeoutClose(const uvw::CloseEvent&, uvw::TimerHandle& timer) {
-        auto httpConnection = getConnection(timer);
-
-        httpConnection->requestTimeoutClosing = false;
-        httpConnection->requestTimeout.reset();
-        httpConnection->eliminate();
-    }
-
-    void HttpConnection::handleResponseTimeoutClose(const uvw::CloseEvent&, uvw::TimerHandle& timer) {
-        auto httpConnection = getConnection(timer);
-
-        httpConnection->responseTimeoutClosing = false;
-        httpConnection->responseTimeout.reset();
-        httpConnection->eliminate();
-    }
-
-    void HttpConnection::handleKeepAliveTimeoutClose(const uvw::CloseEvent&, uvw::TimerHandle& timer) {
-        auto httpConnection = getConnection(timer);
-
-        httpConnection->keepAliveTimeoutClosing = false;
-        httpConnection->keepAliveTimeout.reset();
-        httpConnection->eliminate();
-    }
-
-    void HttpConnection::closeTimeouts() noexcept {
-        if (requestTimeout && !requestTimeoutClosing) {
-            requestTimeoutClosing = true;
-            requestTimeout->close();
-        }
-
-        if (responseTimeout && !responseTimeoutClosing) {
-            responseTimeoutClosing = true;
-            responseTimeout->close();
+        httpConnection->stopReading();
+        if (httpConnection->hasActiveRequest || !httpConnection->requestQueue.empty()) {
+            return;
         }
 
-        if (keepAliveTimeout && !keepAliveTimeoutClosing) {
-            keepAliveTimeoutClosing = true;
-            keepAliveTimeout->close();
-        }
+        httpConnection->close();
     }
 
 } // namespace nex
\ No newline at end of file
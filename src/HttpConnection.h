@@ -6,21 +6,27 @@
 
 #include "commonHeaders.h"
 #include "httpConfig.h"
+#include "loopContext.h"
+#include "http2Connection.h"
 
 #include "abstractRequestProcessor.h"
+#include "outputBatch.h"
+#include "receiveBuffer.h"
+#include "timerWheel.h"
 #include "request.h"
 #include "response.h"
 #include "middleware.h"
 
 namespace nex {
 
-typedef std::chrono::duration<uint64_t, std::milli> Time;
-
-class ParseError : public std::exception {public:using std::exception::exception;};
-class RequestHeadersTooLargeError : public std::exception {public:using std::exception::exception;};
-class NeedMoreDataError : public std::exception {public:using std::exception::exception;};
-class HttpVersionUnsupportedError : public std::exception {public:using std::exception::exception;};
-class UnknownHTTPMethodError : public std::exception {public:using std::exception::exception;};
+enum class HeaderParseStatus {
+    Complete,
+    Incomplete,
+    Invalid,
+    TooLarge,
+    UnknownMethod,
+    UnsupportedVersion
+};
 
 class Request;
 class Response;
@@ -28,12 +34,22 @@ class AbstractRequestProcessor;
 
 class HttpConnection {
 
+    friend class ConnectionHandOff;
     friend class EmbeddedHttp;
+    friend class FileSender;
+    friend class Http2Connection;
+    friend class IoWorker;
+    friend class Pipeline;
     friend class Request;
     friend class Response;
+    friend class WriteScheduler;
+
+    // Keeps a single coalesced write below IOV_MAX
+    static constexpr size_t maxCoalescedBuffers = 512;
+    static constexpr size_t maxHeadersCount = 100;
 
     HttpConnection(
-            std::shared_ptr<uvw::Loop> eventLoop,
+            std::shared_ptr<LoopContext> loopContext,
             v8::Isolate* isolate,
             std::shared_ptr<uvw::TCPHandle> client,
             std::shared_ptr<AbstractRequestProcessor> requestProc,
@@ -42,68 +58,96 @@ class HttpConnection {
 
     static void handleClientError(const uvw::ErrorEvent& err, uvw::TCPHandle& client);
     static void handleDataEnd(const uvw::EndEvent&, uvw::TCPHandle& client);
-    static void handleData(const uvw::DataEvent& data, uvw::TCPHandle& client);
+    static void handleReadAlloc(uv_handle_t* handle, size_t suggestedSize, uv_buf_t* buf);
+    static void handleRead(uv_stream_t* handle, ssize_t bytesRead, const uv_buf_t* buf);
+    static void handleData(uvw::TCPHandle& client);
     static void handleShutdown(const uvw::ShutdownEvent&, uvw::TCPHandle& client);
     static void handleClose(const uvw::CloseEvent&, uvw::TCPHandle& client);
 
-    static void handleRequestTimeout(const uvw::TimerEvent&, uvw::TimerHandle& timer);
-    static void handleResponseTimeout(const uvw::TimerEvent&, uvw::TimerHandle& timer);
-    static void handleKeepAliveTimeout(const uvw::TimerEvent&, uvw::TimerHandle& timer);
-    static void handleRequestTimeoutClose(const uvw::CloseEvent&, uvw::TimerHandle& timer);
-    static void handleResponseTimeoutClose(const uvw::CloseEvent&, uvw::TimerHandle& timer);
-    static void handleKeepAliveTimeoutClose(const uvw::CloseEvent&, uvw::TimerHandle& timer);
+    static void handleRequestTimeout(TimerEntry& timer);
+    static void handleResponseTimeout(TimerEntry& timer);
+    static void handleKeepAliveTimeout(TimerEntry& timer);
+    static void handleHandOffRetry(TimerEntry& timer);
 
-    static void parseHeaders(
+    static HeaderParseStatus parseHeaders(
             const char* buffer,
             uint32_t bufferStart,
             uint32_t bufferLength,
-            std::vector<phr_header>& headers,
-            std::string& path,
+            uint32_t previousBufferLength,
+            phr_header* headers,
+            size_t& headersCount,
+            std::string_view& path,
             HttpMethod& method,
             uint32_t& minorVersion,
             uint32_t& bodyStart
     );
 
-    static inline void packHeaders(
-            const std::vector<phr_header>& headers,
-            const std::shared_ptr<Request>& req
-    );
-
     template<class T>
     static std::shared_ptr<HttpConnection> getConnection(T& client) {
         return std::move(client.template data<HttpConnection>());
     }
 
+    void attachClient();
+    void startReading();
+    void stopReading();
+    void scheduleFlush();
+    void flush();
+    void handleWriteError(int status);
+
+    /**
+     * Flushes and calls back once everything queued is handed to the socket, used before
+     * writing to the socket descriptor directly. Called back right away when nothing is queued.
+     */
+    void flush(std::function<void(int)> onWritten);
     void close();
     void end();
     void eliminate();
 
-    void parseRequest(const std::string& buffer, uint32_t& bufferPosition);
+    /**
+     * Returns false when the request is rejected and nothing after it can be parsed
+     */
+    [[nodiscard]] bool parseRequest(const char* buffer, uint32_t bufferLength, uint32_t& bufferPosition);
     void processNextRequest();
-    void updateRequestBodyBuffer(const std::string& buffer, uint32_t& bufferPosition);
+    void updateRequestBodyBuffer(const char* buffer, uint32_t bufferLength, uint32_t& bufferPosition);
     [[nodiscard]] bool isRequestLimitExceeded() const;
 
+    // HTTP/2 with prior knowledge, detected from the client connection preface
+    [[nodiscard]] bool acceptsHttp2() const noexcept;
+    [[nodiscard]] bool startHttp2();
+    void receiveHttp2();
+
+    // Hand-off from an I/O thread to the main loop
+    [[nodiscard]] bool requiresIsolate(const Request& req) const;
+    void handOff();
+    void completeHandOff();
+    void adopt(
+            std::shared_ptr<LoopContext> loopContext,
+            std::shared_ptr<uvw::TCPHandle> clientHandle,
+            uv_os_sock_t socket
+    );
+
     void startRequestTimer();
     void startResponseTimer();
     void startKeepAliveTimer();
     void stopRequestTimer();
     void stopResponseTimer();
     void stopKeepAliveTimer();
-    void closeTimeouts() noexcept;
+    void stopTimers() noexcept;
 
     std::shared_ptr<Request> createRequest(
-            const std::vector<phr_header>& headers,
-            const std::string& path,
+            std::string_view headerBlock,
+            const phr_header* headers,
+            size_t headersCount,
+            std::string_view path,
             HttpMethod method,
             uint32_t minorVersion
     );
     std::shared_ptr<Request> createRequest(uint32_t errorCode, uint32_t minorVersion = 1);
     std::shared_ptr<Response> createResponse(const std::shared_ptr<Request>& req);
 
+    std::shared_ptr<LoopContext> context;
     std::shared_ptr<uvw::Loop> loop;
     std::shared_ptr<uvw::TCPHandle> client;
-    std::shared_ptr<uvw::TimerHandle> requestTimeout{nullptr},
-            responseTimeout{nullptr}, keepAliveTimeout{nullptr};
     std::shared_ptr<HttpConnection> thisRef{this, noop<HttpConnection>};
     std::shared_ptr<HttpServerConfig> config;
 
@@ -116,21 +160,35 @@ class HttpConnection {
 
     uint32_t requestsAccepted = 0;
     uint32_t lastContentLeft = 0;
+    // Bytes of incomplete headers the parser has already seen
+    uint32_t parsedHeaderLength = 0;
+
+    ReceiveBuffer receiveBuffer;
+    OutputBatch output;
 
-    std::string headerBuffer;
+    TimerEntry requestTimer{handleRequestTimeout, this};
+    TimerEntry responseTimer{handleResponseTimeout, this};
+    TimerEntry keepAliveTimer{handleKeepAliveTimeout, this};
+    TimerEntry handOffTimer{handleHandOffRetry, this};
+
+    std::string pendingInput;
+    uv_os_sock_t handOffSocket = -1;
 
     bool active = true;
+    bool reading = false;
 
     bool needMoreDataToParseHeaders = false;
     bool needMoreDataToGetBody = false;
 
     bool hasActiveRequest = false;
+    bool flushScheduled = false;
 
     bool shuttingDown = false;
     bool closing = false;
-    bool requestTimeoutClosing = false;
-    bool responseTimeoutClosing = false;
-    bool keepAliveTimeoutClosing = false;
+    bool handingOff = false;
+
+    // Set once the connection speaks HTTP/2, destroyed ahead of the rest of the connection
+    std::unique_ptr<Http2Connection> http2{nullptr};
 
 };  // class HttpConnection
 
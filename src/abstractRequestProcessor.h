@@ -7,9 +7,16 @@
 namespace nex {
     class Request;
     class Response;
+    class RouteCache;
 
     class AbstractRequestProcessor {
     public:
         virtual void process(std::shared_ptr<Request> req, std::shared_ptr<Response> res) = 0;
+
+        /**
+         * Whether processing a request may call into JS, i.e. has to happen on the isolate thread.
+         * Matches found on the way go to the route cache of the calling loop.
+         */
+        virtual bool requiresIsolate(HttpMethod, const std::string&, RouteCache&) const { return true; }
     };
 }
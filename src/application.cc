@@ -14,6 +14,8 @@ namespace nex {
         NODE_SET_PROTOTYPE_METHOD(tpl, "close", Close);
         NODE_SET_PROTOTYPE_METHOD(tpl, "use", Use);
         NODE_SET_PROTOTYPE_METHOD(tpl, "set", Set);
+        NODE_SET_PROTOTYPE_METHOD(tpl, "routeCacheStats", RouteCacheStats);
+        NODE_SET_PROTOTYPE_METHOD(tpl, "regexStats", RegexStats);
 
         Local<v8::Context> context = isolate->GetCurrentContext();
         constructor.Reset(isolate, tpl->GetFunction(context).ToLocalChecked());
@@ -122,6 +124,87 @@ namespace nex {
             return;
         }
 
+        if (settingName == "readBufferBlockSize") {
+            if (!args[1]->IsNumber()) {
+                return;
+            }
+            auto value = static_cast<uint32_t>(args[1].As<v8::Number>()->Value());
+            httpConfig->readBufferBlockSize = value;
+            return;
+        }
+
+        if (settingName == "readBufferPoolLimit") {
+            if (!args[1]->IsNumber()) {
+                return;
+            }
+            auto value = static_cast<uint32_t>(args[1].As<v8::Number>()->Value());
+            httpConfig->readBufferPoolLimit = value;
+            return;
+        }
+
+        if (settingName == "readBufferScratchSize") {
+            if (!args[1]->IsNumber()) {
+                return;
+            }
+            auto value = static_cast<uint32_t>(args[1].As<v8::Number>()->Value());
+            httpConfig->readBufferScratchSize = value;
+            return;
+        }
+
+        if (settingName == "sharedReadBuffer") {
+            if (!args[1]->IsBoolean()) {
+                return;
+            }
+            auto value = args[1].As<v8::Boolean>()->Value();
+            httpConfig->sharedReadBuffer = value;
+            return;
+        }
+
+        if (settingName == "maxCoalescedWriteSize") {
+            if (!args[1]->IsNumber()) {
+                return;
+            }
+            auto value = static_cast<uint32_t>(args[1].As<v8::Number>()->Value());
+            httpConfig->maxCoalescedWriteSize = value;
+            return;
+        }
+
+        if (settingName == "coalesceWrites") {
+            if (!args[1]->IsBoolean()) {
+                return;
+            }
+            auto value = args[1].As<v8::Boolean>()->Value();
+            httpConfig->coalesceWrites = value;
+            return;
+        }
+
+        if (settingName == "ioThreads") {
+            if (!args[1]->IsNumber()) {
+                return;
+            }
+            auto value = static_cast<uint32_t>(args[1].As<v8::Number>()->Value());
+            httpConfig->ioThreads = value;
+            return;
+        }
+
+        if (settingName == "routeCacheSize") {
+            if (!args[1]->IsNumber()) {
+                return;
+            }
+            auto value = static_cast<uint32_t>(args[1].As<v8::Number>()->Value());
+            httpConfig->routeCacheSize = value;
+            return;
+        }
+
+        if (settingName == "staticMaxOpenFiles") {
+            if (!args[1]->IsNumber()) {
+                return;
+            }
+            auto value = static_cast<uint32_t>(args[1].As<v8::Number>()->Value());
+            httpConfig->staticMaxOpenFiles = value;
+            return;
+        }
+
         if (settingName == "keepAlive") {
             if (!args[1]->IsBoolean()) {
                 return;
@@ -131,6 +214,24 @@ namespace nex {
             return;
         }
 
+        if (settingName == "http2") {
+            if (!args[1]->IsBoolean()) {
+                return;
+            }
+            auto value = args[1].As<v8::Boolean>()->Value();
+            httpConfig->http2 = value;
+            return;
+        }
+
+        if (settingName == "http2MaxConcurrentStreams") {
+            if (!args[1]->IsNumber()) {
+                return;
+            }
+            auto value = static_cast<uint32_t>(args[1].As<v8::Number>()->Value());
+            httpConfig->http2MaxConcurrentStreams = value;
+            return;
+        }
+
         if (settingName == "protocol") {
             if (!args[1]->IsString()) {
                 return;
@@ -162,7 +263,56 @@ namespace nex {
         port = static_cast<uint16_t>(portInternal->Value());
 
         auto app = ObjectWrap::Unwrap<Application>(args.Holder());
-        app->listen(ipAddress, port);
+
+        try {
+            app->listen(ipAddress, port);
+        } catch (const std::regex_error& e) {
+            isolate->ThrowException(v8::Exception::SyntaxError(v8::String::NewFromUtf8(
+                    isolate, (std::string("Invalid route pattern: ") + e.what()).c_str(),
+                    v8::NewStringType::kNormal).ToLocalChecked()));
+        }
+    }
+
+    void Application::RouteCacheStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        v8::Isolate* isolate = args.GetIsolate();
+        v8::Local<v8::Context> context = isolate->GetCurrentContext();
+        auto app = ObjectWrap::Unwrap<Application>(args.Holder());
+        uint64_t hits = 0, misses = 0, evictions = 0;
+
+        if (app->http) {
+            app->http->getRouteCacheStats(hits, misses, evictions);
+        }
+
+        auto stats = v8::Object::New(isolate);
+        auto setCounter = [&](const char* name, uint64_t value) {
+            auto key = v8::String::NewFromUtf8(isolate, name, v8::NewStringType::kInternalized).ToLocalChecked();
+            stats->Set(context, key, v8::Number::New(isolate, static_cast<double>(value))).Check();
+        };
+
+        setCounter("hits", hits);
+        setCounter("misses", misses);
+        setCounter("evictions", evictions);
+
+        args.GetReturnValue().Set(stats);
+    }
+
+    void Application::RegexStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        v8::Isolate* isolate = args.GetIsolate();
+        v8::Local<v8::Context> context = isolate->GetCurrentContext();
+        auto compileStats = PathRegExp::getCompileStats();
+
+        auto stats = v8::Object::New(isolate);
+        auto setValue = [&](const char* name, double value) {
+            auto key = v8::String::NewFromUtf8(isolate, name, v8::NewStringType::kInternalized).ToLocalChecked();
+            stats->Set(context, key, v8::Number::New(isolate, value)).Check();
+        };
+
+        setValue("compiled", static_cast<double>(compileStats.compiled));
+        setValue("reused", static_cast<double>(compileStats.reused));
+        setValue("live", static_cast<double>(compileStats.live));
+        setValue("compileTimeMs", static_cast<double>(compileStats.compileTime) / 1e6);
+
+        args.GetReturnValue().Set(stats);
     }
 
     void Application::Close(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -171,6 +321,9 @@ namespace nex {
     }
 
     void Application::listen(const std::string &ip, uint16_t port) {
+        // Ahead of anything else, a bad route pattern leaves the application as it was
+        routerInstance->freeze();
+
         Ref();
         if (!httpConfig) {
             httpConfig = std::make_shared<HttpServerConfig>();
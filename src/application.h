@@ -32,6 +32,8 @@ namespace nex {
         static void Listen(const v8::FunctionCallbackInfo<v8::Value>& args);
         static void Close(const v8::FunctionCallbackInfo<v8::Value>& args);
         static void Set(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void RouteCacheStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void RegexStats(const v8::FunctionCallbackInfo<v8::Value>& args);
 
         static v8::Global<v8::Function> constructor;
 
@@ -0,0 +1,31 @@
+#include <node_buffer.h>
+
+#include "bodyChunk.h"
+
+namespace nex {
+
+    BodyChunk::BodyChunk(std::string_view data)
+        : bytes(std::make_shared<std::string>(data))
+    {}
+
+    BodyChunk::BodyChunk(std::string&& data)
+        : bytes(std::make_shared<std::string>(std::move(data)))
+    {}
+
+    v8::MaybeLocal<v8::Object> BodyChunk::toBuffer(v8::Isolate* isolate) const {
+        // The Buffer owns a reference to the block, dropped by V8 when the Buffer is collected.
+        // Node calls the free callback itself when creating the Buffer fails.
+        auto reference = new std::shared_ptr<std::string>(bytes);
+
+        return node::Buffer::New(
+                isolate,
+                bytes->data(),
+                bytes->size(),
+                [](char*, void* hint) {
+                    delete static_cast<std::shared_ptr<std::string>*>(hint);
+                },
+                reference
+        );
+    }
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <node.h>
+
+#include "commonHeaders.h"
+
+namespace nex {
+
+/**
+ * Received request body bytes in a refcounted block. JS Buffers created from a chunk view
+ * the block directly and keep it alive until they are collected.
+ */
+class BodyChunk {
+public:
+    /**
+     * Copies bytes that are only valid during the read callback
+     */
+    explicit BodyChunk(std::string_view data);
+
+    /**
+     * Takes over bytes that were buffered while nobody listened
+     */
+    explicit BodyChunk(std::string&& data);
+
+    [[nodiscard]] std::string_view view() const noexcept { return *bytes; }
+    [[nodiscard]] size_t size() const noexcept { return bytes->size(); }
+
+    [[nodiscard]] v8::MaybeLocal<v8::Object> toBuffer(v8::Isolate* isolate) const;
+
+private:
+    std::shared_ptr<std::string> bytes;
+};
+
+}
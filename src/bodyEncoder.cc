@@ -0,0 +1,308 @@
+#include "bodyEncoder.h"
+
+namespace nex {
+
+    namespace {
+        constexpr size_t outputStep = 16 * 1024;
+        constexpr int zlibWindowBits = 15;
+        constexpr int zlibMemoryLevel = 8;
+        // Added to the window bits, makes zlib write a gzip header and trailer
+        constexpr int gzipWrapper = 16;
+
+        /**
+         * q-value of an Accept-Encoding parameter list in thousandths, 1000 when absent
+         */
+        int parseQuality(std::string_view parameters) noexcept {
+            while (!parameters.empty()) {
+                auto end = parameters.find(';');
+                auto parameter = trim(parameters.substr(0, end));
+
+                parameters = end == std::string_view::npos ? std::string_view() : parameters.substr(end + 1);
+
+                if (parameter.size() < 3 || (parameter[0] != 'q' && parameter[0] != 'Q') || parameter[1] != '=') {
+                    continue;
+                }
+
+                auto value = parameter.substr(2);
+
+                if (value.empty() || value[0] < '0' || value[0] > '1') {
+                    return 0;
+                }
+
+                int quality = (value[0] - '0') * 1000;
+                int scale = 100;
+
+                if (value.size() > 1 && value[1] == '.') {
+                    for (size_t i = 2; i < value.size() && i < 5 && value[i] >= '0' && value[i] <= '9'; ++i) {
+                        quality += (value[i] - '0') * scale;
+                        scale /= 10;
+                    }
+                }
+
+                return std::min(quality, 1000);
+            }
+
+            return 1000;
+        }
+
+        /**
+         * Rank of a coding among equally weighted ones, higher is preferred
+         */
+        int getPreference(ContentCoding coding) noexcept {
+            switch (coding) {
+                case ContentCoding::Brotli:
+                    return 3;
+                case ContentCoding::Gzip:
+                    return 2;
+                case ContentCoding::Deflate:
+                    return 1;
+                default:
+                    return 0;
+            }
+        }
+    }
+
+    // ZlibEncoder
+
+    ZlibEncoder::ZlibEncoder(ContentCoding coding, int level)
+        : coding(coding), level(level)
+    {
+        auto windowBits = coding == ContentCoding::Gzip ? zlibWindowBits + gzipWrapper : zlibWindowBits;
+
+        if (deflateInit2(&stream, level, Z_DEFLATED, windowBits, zlibMemoryLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("Couldn't initialize zlib stream");
+        }
+    }
+
+    ZlibEncoder::~ZlibEncoder() {
+        deflateEnd(&stream);
+    }
+
+    bool ZlibEncoder::encode(std::string_view input, bool finish, std::string& output) {
+        if (failed) {
+            return false;
+        }
+
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream.avail_in = static_cast<uInt>(input.size());
+
+        auto flush = finish ? Z_FINISH : Z_NO_FLUSH;
+        // A whole body usually fits the bound at once
+        auto step = finish ? std::max(outputStep, static_cast<size_t>(deflateBound(&stream, stream.avail_in))) : outputStep;
+
+        while (true) {
+            auto offset = output.size();
+
+            output.resize(offset + step);
+            stream.next_out = reinterpret_cast<Bytef*>(&output[offset]);
+            stream.avail_out = static_cast<uInt>(step);
+
+            auto result = deflate(&stream, flush);
+
+            output.resize(offset + step - stream.avail_out);
+
+            if (result == Z_STREAM_ERROR) {
+                failed = true;
+                return false;
+            }
+
+            if (stream.avail_out != 0 && (!finish || result == Z_STREAM_END || result == Z_BUF_ERROR)) {
+                return true;
+            }
+
+            step = outputStep;
+        }
+    }
+
+    bool ZlibEncoder::reset() noexcept {
+        if (failed) {
+            return false;
+        }
+
+        return deflateReset(&stream) == Z_OK;
+    }
+
+    // BrotliBodyEncoder
+
+    BrotliBodyEncoder::BrotliBodyEncoder(int quality)
+        : quality(quality)
+    {
+        createState();
+    }
+
+    BrotliBodyEncoder::~BrotliBodyEncoder() {
+        if (state) {
+            BrotliEncoderDestroyInstance(state);
+        }
+    }
+
+    void BrotliBodyEncoder::createState() {
+        state = BrotliEncoderCreateInstance(nullptr, nullptr, nullptr);
+
+        if (!state) {
+            throw std::runtime_error("Couldn't initialize brotli encoder");
+        }
+
+        BrotliEncoderSetParameter(state, BROTLI_PARAM_QUALITY, static_cast<uint32_t>(quality));
+        BrotliEncoderSetParameter(state, BROTLI_PARAM_MODE, BROTLI_MODE_TEXT);
+    }
+
+    bool BrotliBodyEncoder::encode(std::string_view input, bool finish, std::string& output) {
+        if (!state) {
+            return false;
+        }
+
+        auto nextIn = reinterpret_cast<const uint8_t*>(input.data());
+        auto availableIn = input.size();
+        auto operation = finish ? BROTLI_OPERATION_FINISH : BROTLI_OPERATION_PROCESS;
+
+        while (true) {
+            size_t availableOut = 0;
+
+            if (!BrotliEncoderCompressStream(state, operation, &availableIn, &nextIn, &availableOut, nullptr, nullptr)) {
+                return false;
+            }
+
+            size_t size = 0;
+            auto data = BrotliEncoderTakeOutput(state, &size);
+
+            output.append(reinterpret_cast<const char*>(data), size);
+
+            if (!availableIn && !BrotliEncoderHasMoreOutput(state) && (!finish || BrotliEncoderIsFinished(state))) {
+                return true;
+            }
+        }
+    }
+
+    bool BrotliBodyEncoder::reset() noexcept {
+        // Brotli can't restart a stream, only the allocation of the wrapper is saved
+        if (state) {
+            BrotliEncoderDestroyInstance(state);
+            state = nullptr;
+        }
+
+        try {
+            createState();
+        } catch (const std::exception&) {
+            return false;
+        }
+
+        return true;
+    }
+
+    // EncoderPool
+
+    std::unique_ptr<BodyEncoder> EncoderPool::acquire(ContentCoding coding, const CompressionOptions& options) {
+        auto level = coding == ContentCoding::Brotli ? options.brotliQuality : options.level;
+
+        for (auto it = encoders.rbegin(); it != encoders.rend(); ++it) {
+            if ((*it)->getCoding() == coding && (*it)->getLevel() == level) {
+                auto encoder = std::move(*it);
+
+                encoders.erase(std::next(it).base());
+
+                return encoder;
+            }
+        }
+
+        try {
+            if (coding == ContentCoding::Brotli) {
+                return std::make_unique<BrotliBodyEncoder>(level);
+            }
+
+            if (coding == ContentCoding::Gzip || coding == ContentCoding::Deflate) {
+                return std::make_unique<ZlibEncoder>(coding, level);
+            }
+        } catch (const std::exception&) {}
+
+        return nullptr;
+    }
+
+    void EncoderPool::release(std::unique_ptr<BodyEncoder> encoder) noexcept {
+        if (!encoder || encoders.size() >= maxPooled || !encoder->reset()) {
+            return;
+        }
+
+        try {
+            encoders.push_back(std::move(encoder));
+        } catch (const std::exception&) {}
+    }
+
+    // Negotiation
+
+    ContentCoding negotiateCoding(std::string_view acceptEncoding, bool allowBrotli) noexcept {
+        auto best = ContentCoding::Identity;
+        int bestQuality = 0;
+
+        while (!acceptEncoding.empty()) {
+            auto end = acceptEncoding.find(',');
+            auto item = acceptEncoding.substr(0, end);
+
+            acceptEncoding = end == std::string_view::npos ? std::string_view() : acceptEncoding.substr(end + 1);
+
+            auto parametersStart = item.find(';');
+            auto name = trim(item.substr(0, parametersStart));
+            auto quality = parametersStart == std::string_view::npos
+                    ? 1000
+                    : parseQuality(item.substr(parametersStart + 1));
+            auto coding = ContentCoding::Identity;
+
+            if (allowBrotli && equalsCaseInsensitive(name, "br")) {
+                coding = ContentCoding::Brotli;
+            } else if (equalsCaseInsensitive(name, "gzip") || name == "*") {
+                coding = ContentCoding::Gzip;
+            } else if (equalsCaseInsensitive(name, "deflate")) {
+                coding = ContentCoding::Deflate;
+            }
+
+            if (coding == ContentCoding::Identity || quality == 0) {
+                continue;
+            }
+
+            if (quality > bestQuality || (quality == bestQuality && getPreference(coding) > getPreference(best))) {
+                best = coding;
+                bestQuality = quality;
+            }
+        }
+
+        return best;
+    }
+
+    std::string_view getCodingName(ContentCoding coding) noexcept {
+        switch (coding) {
+            case ContentCoding::Gzip:
+                return "gzip";
+            case ContentCoding::Deflate:
+                return "deflate";
+            case ContentCoding::Brotli:
+                return "br";
+            default:
+                return "identity";
+        }
+    }
+
+    bool isCompressible(std::string_view contentType) noexcept {
+        auto mediaType = trim(contentType.substr(0, contentType.find(';')));
+        auto hasPrefix = [mediaType](std::string_view prefix) {
+            return mediaType.size() >= prefix.size() && equalsCaseInsensitive(mediaType.substr(0, prefix.size()), prefix);
+        };
+        auto hasSuffix = [mediaType](std::string_view suffix) {
+            return mediaType.size() >= suffix.size()
+                && equalsCaseInsensitive(mediaType.substr(mediaType.size() - suffix.size()), suffix);
+        };
+
+        // Event streams must reach the client as they are written
+        if (hasPrefix("text/event-stream")) {
+            return false;
+        }
+
+        return hasPrefix("text/")
+            || hasSuffix("+json")
+            || hasSuffix("+xml")
+            || equalsCaseInsensitive(mediaType, "application/json")
+            || equalsCaseInsensitive(mediaType, "application/javascript")
+            || equalsCaseInsensitive(mediaType, "application/x-javascript")
+            || equalsCaseInsensitive(mediaType, "application/xml");
+    }
+
+}
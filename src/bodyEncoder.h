@@ -0,0 +1,121 @@
+#pragma once
+
+#include <zlib.h>
+#include <brotli/encode.h>
+
+#include "commonHeaders.h"
+
+namespace nex {
+
+enum class ContentCoding : uint8_t {
+    Identity,
+    Gzip,
+    Deflate,
+    Brotli
+};
+
+struct CompressionOptions {
+    // zlib level 1-9, Z_DEFAULT_COMPRESSION picks zlib's own default
+    int level = Z_DEFAULT_COMPRESSION;
+    // Brotli's default quality is meant for static assets, dynamic responses need a cheaper one
+    int brotliQuality = 4;
+    // Bodies passed to send() below this size are left uncompressed
+    size_t threshold = 1024;
+    // Bodies passed to send() from this size on are compressed on the libuv threadpool, 0 never does
+    size_t threadPoolThreshold = 256 * 1024;
+    bool brotli = true;
+};
+
+/**
+ * Streaming encoder of one content coding, reset and reused across responses.
+ */
+class BodyEncoder {
+public:
+    virtual ~BodyEncoder() = default;
+
+    [[nodiscard]] virtual ContentCoding getCoding() const noexcept = 0;
+    [[nodiscard]] virtual int getLevel() const noexcept = 0;
+
+    /**
+     * Compresses `input` and appends whatever output is ready, `finish` ends the stream
+     */
+    virtual bool encode(std::string_view input, bool finish, std::string& output) = 0;
+
+    /**
+     * Prepares a new stream, false when the encoder can't be used anymore
+     */
+    virtual bool reset() noexcept = 0;
+};
+
+class ZlibEncoder final : public BodyEncoder {
+public:
+    ZlibEncoder(ContentCoding coding, int level);
+    ZlibEncoder(const ZlibEncoder&) = delete;
+    ZlibEncoder& operator=(const ZlibEncoder&) = delete;
+    ~ZlibEncoder() final;
+
+    [[nodiscard]] ContentCoding getCoding() const noexcept final { return coding; }
+    [[nodiscard]] int getLevel() const noexcept final { return level; }
+
+    bool encode(std::string_view input, bool finish, std::string& output) final;
+    bool reset() noexcept final;
+
+private:
+    z_stream stream{};
+    ContentCoding coding;
+    int level;
+    bool failed = false;
+};
+
+class BrotliBodyEncoder final : public BodyEncoder {
+public:
+    explicit BrotliBodyEncoder(int quality);
+    BrotliBodyEncoder(const BrotliBodyEncoder&) = delete;
+    BrotliBodyEncoder& operator=(const BrotliBodyEncoder&) = delete;
+    ~BrotliBodyEncoder() final;
+
+    [[nodiscard]] ContentCoding getCoding() const noexcept final { return ContentCoding::Brotli; }
+    [[nodiscard]] int getLevel() const noexcept final { return quality; }
+
+    bool encode(std::string_view input, bool finish, std::string& output) final;
+    bool reset() noexcept final;
+
+private:
+    void createState();
+
+    BrotliEncoderState* state = nullptr;
+    int quality;
+};
+
+/**
+ * Idle encoders of one event loop, so that deflate windows and brotli state aren't
+ * allocated and torn down for every response.
+ */
+class EncoderPool {
+public:
+    EncoderPool() = default;
+    EncoderPool(const EncoderPool&) = delete;
+    EncoderPool& operator=(const EncoderPool&) = delete;
+
+    [[nodiscard]] std::unique_ptr<BodyEncoder> acquire(ContentCoding coding, const CompressionOptions& options);
+    void release(std::unique_ptr<BodyEncoder> encoder) noexcept;
+
+private:
+    static constexpr size_t maxPooled = 32;
+
+    std::vector<std::unique_ptr<BodyEncoder>> encoders;
+};
+
+/**
+ * Coding preferred by an Accept-Encoding value, Identity when nothing acceptable is offered
+ */
+[[nodiscard]] ContentCoding negotiateCoding(std::string_view acceptEncoding, bool allowBrotli) noexcept;
+
+[[nodiscard]] std::string_view getCodingName(ContentCoding coding) noexcept;
+
+/**
+ * Whether a body of this type is worth compressing, text-like types are
+ */
+[[nodiscard]] bool isCompressible(std::string_view contentType) noexcept;
+
+}
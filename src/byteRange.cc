@@ -0,0 +1,122 @@
+#include "byteRange.h"
+
+namespace nex {
+
+    namespace {
+        // More ranges than that are answered with the whole body
+        constexpr size_t maxRanges = 64;
+
+        bool parseNumber(std::string_view value, uint64_t& number) noexcept {
+            if (value.empty()) {
+                return false;
+            }
+
+            auto end = value.data() + value.length();
+            auto [parsed, error] = std::from_chars(value.data(), end, number);
+
+            return error == std::errc() && parsed == end;
+        }
+    }
+
+    RangeParseStatus parseRange(std::string_view header, uint64_t size, std::vector<ByteRange>& ranges) {
+        constexpr std::string_view unit = "bytes=";
+
+        ranges.clear();
+        header = trim(header);
+
+        if (header.length() <= unit.length() || !equalsCaseInsensitive(header.substr(0, unit.length()), unit)) {
+            return RangeParseStatus::Ignored;
+        }
+
+        header.remove_prefix(unit.length());
+
+        bool hasSpecs = false;
+
+        while (!header.empty()) {
+            auto end = header.find(',');
+            auto spec = trim(header.substr(0, end));
+
+            header = end == std::string_view::npos ? std::string_view() : header.substr(end + 1);
+
+            // Empty list elements are allowed
+            if (spec.empty()) {
+                continue;
+            }
+
+            auto dash = spec.find('-');
+
+            hasSpecs = true;
+
+            if (dash == std::string_view::npos || ranges.size() == maxRanges) {
+                return RangeParseStatus::Ignored;
+            }
+
+            uint64_t first, last;
+
+            // `-n` are the last n bytes
+            if (dash == 0) {
+                if (!parseNumber(spec.substr(1), last)) {
+                    return RangeParseStatus::Ignored;
+                }
+
+                if (last && size) {
+                    auto length = std::min(last, size);
+
+                    ranges.push_back(ByteRange{size - length, length});
+                }
+                continue;
+            }
+
+            if (!parseNumber(spec.substr(0, dash), first)) {
+                return RangeParseStatus::Ignored;
+            }
+
+            auto lastValue = spec.substr(dash + 1);
+
+            if (lastValue.empty()) {
+                last = UINT64_MAX;
+            } else if (!parseNumber(lastValue, last) || last < first) {
+                return RangeParseStatus::Ignored;
+            }
+
+            if (first >= size) {
+                continue;
+            }
+
+            last = std::min(last, size - 1);
+            ranges.push_back(ByteRange{first, last - first + 1});
+        }
+
+        if (ranges.empty()) {
+            return hasSpecs ? RangeParseStatus::Unsatisfiable : RangeParseStatus::Ignored;
+        }
+
+        std::sort(ranges.begin(), ranges.end(), [](const ByteRange& first, const ByteRange& second) {
+            return first.offset < second.offset;
+        });
+
+        size_t merged = 0;
+
+        for (size_t i = 1; i < ranges.size(); ++i) {
+            auto& previous = ranges[merged];
+            auto previousEnd = previous.offset + previous.length;
+
+            if (ranges[i].offset <= previousEnd) {
+                previous.length = std::max(previousEnd, ranges[i].offset + ranges[i].length) - previous.offset;
+                continue;
+            }
+
+            ranges[++merged] = ranges[i];
+        }
+
+        ranges.resize(merged + 1);
+
+        return RangeParseStatus::Satisfiable;
+    }
+
+    std::string getContentRange(const ByteRange& range, uint64_t size) {
+        return "bytes " + std::to_string(range.offset) + "-" + std::to_string(range.offset + range.length - 1)
+            + "/" + std::to_string(size);
+    }
+
+}
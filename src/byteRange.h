@@ -0,0 +1,32 @@
+#pragma once
+
+#include "commonHeaders.h"
+
+namespace nex {
+
+struct ByteRange {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+enum class RangeParseStatus : uint8_t {
+    // No usable Range header, the whole body is sent
+    Ignored,
+    Satisfiable,
+    // None of the ranges overlaps the body, answered with 416
+    Unsatisfiable
+};
+
+/**
+ * Parses a `bytes=` Range header against a body of `size` bytes. Ranges come out sorted
+ * and with overlapping or adjacent ones merged, so that a request can't make the same
+ * bytes go out many times.
+ */
+[[nodiscard]] RangeParseStatus parseRange(std::string_view header, uint64_t size, std::vector<ByteRange>& ranges);
+
+/**
+ * `bytes first-last/size` of a Content-Range header
+ */
+[[nodiscard]] std::string getContentRange(const ByteRange& range, uint64_t size);
+
+}
@@ -1,16 +1,27 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
 #include <functional>
 #include <map>
 #include <string>
+#include <string_view>
+#include <cstring>
 #include <utility>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <exception>
 #include <regex>
 #include <iostream>
 #include <fstream>
 #include <variant>
 #include <queue>
+#include <deque>
+#include <list>
+#include <unordered_map>
 
 #include "helpers/methods.h"
 #include "helpers/miscellaneous.h"
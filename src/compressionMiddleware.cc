@@ -0,0 +1,95 @@
+#include "compressionMiddleware.h"
+
+namespace nex {
+
+    namespace {
+        /**
+         * Reads a numeric option within bounds, leaves `target` as is when the option is absent
+         */
+        template<class T>
+        bool readOption(
+            v8::Isolate* isolate,
+            v8::Local<v8::Object> options,
+            const char* name,
+            double min,
+            double max,
+            T& target
+        ) {
+            auto context = isolate->GetCurrentContext();
+            auto key = v8::String::NewFromUtf8(isolate, name, v8::NewStringType::kInternalized).ToLocalChecked();
+            v8::Local<v8::Value> value;
+
+            if (!options->Get(context, key).ToLocal(&value) || value->IsUndefined()) {
+                return true;
+            }
+
+            if (!value->IsNumber()) {
+                return false;
+            }
+
+            auto number = value.As<v8::Number>()->Value();
+
+            if (number < min || number > max) {
+                return false;
+            }
+
+            target = static_cast<T>(number);
+            return true;
+        }
+    }
+
+    CompressionMiddleware::CompressionMiddleware(const CompressionOptions& options)
+        : options(options)
+    {}
+
+    void CompressionMiddleware::emit(
+        std::shared_ptr<Request> req,
+        std::shared_ptr<Response> res,
+        NextObject& next
+    ) {
+        if (req->getHttpMethod() != HEAD) {
+            auto coding = negotiateCoding(req->getHeaderView(KnownHeader::AcceptEncoding), options.brotli);
+
+            res->setContentCoding(coding, options);
+        }
+
+        next.next();
+    }
+
+    void CompressionMiddleware::NewInstance(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = args.GetIsolate();
+        auto context = isolate->GetCurrentContext();
+        CompressionOptions options;
+
+        if (args.Length() > 0 && args[0]->IsObject()) {
+            auto optionsObject = args[0].As<v8::Object>();
+            auto maxSize = static_cast<double>(std::numeric_limits<uint32_t>::max());
+
+            auto isValid = readOption(isolate, optionsObject, "level", -1, 9, options.level)
+                && readOption(isolate, optionsObject, "brotliQuality", 0, 11, options.brotliQuality)
+                && readOption(isolate, optionsObject, "threshold", 0, maxSize, options.threshold)
+                && readOption(isolate, optionsObject, "threadPoolThreshold", 0, maxSize, options.threadPoolThreshold);
+
+            if (!isValid) {
+                isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8(
+                        isolate, "Invalid compression options", v8::NewStringType::kNormal).ToLocalChecked()));
+                return;
+            }
+
+            auto brotliKey = v8::String::NewFromUtf8(isolate, "brotli", v8::NewStringType::kInternalized).ToLocalChecked();
+            v8::Local<v8::Value> brotli;
+
+            if (optionsObject->Get(context, brotliKey).ToLocal(&brotli) && brotli->IsBoolean()) {
+                options.brotli = brotli.As<v8::Boolean>()->Value();
+            }
+        }
+
+        v8::Local<v8::Object> instance;
+        auto middleware = std::make_shared<CompressionMiddleware>(options);
+
+        if (NativeLoadedMiddlewareWrapper::FromMiddleware(isolate, middleware).ToLocal(&instance)) {
+            args.GetReturnValue().Set(instance);
+        }
+    }
+
+}
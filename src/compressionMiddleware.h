@@ -0,0 +1,36 @@
+#pragma once
+
+#include <node.h>
+
+#include "commonHeaders.h"
+#include "bodyEncoder.h"
+#include "middleware.h"
+
+namespace nex {
+
+/**
+ * Negotiates Accept-Encoding and has the response compress its body natively,
+ * without the body ever passing through a JS compression stream.
+ */
+class CompressionMiddleware final : public ApplicationMiddleware {
+public:
+    explicit CompressionMiddleware(const CompressionOptions& options);
+
+    bool requiresIsolate(HttpMethod, const std::string&) const final { return false; }
+
+    void emit(
+        std::shared_ptr<Request> req,
+        std::shared_ptr<Response> res,
+        NextObject& next
+    ) final;
+
+    /**
+     * `compression(options)` of the JS API, returns a native middleware object
+     */
+    static void NewInstance(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+private:
+    CompressionOptions options;
+};
+
+}
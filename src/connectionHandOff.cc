@@ -0,0 +1,93 @@
+#include "connectionHandOff.h"
+
+#include "httpConnection.h"
+
+namespace nex {
+
+    ConnectionHandOff::ConnectionHandOff(
+        std::shared_ptr<LoopContext> mainContext,
+        WorkerStoppedCallback onWorkerStopped,
+        CloseCallback onClose
+    ):
+        context(std::move(mainContext)),
+        workerStoppedCallback(std::move(onWorkerStopped)),
+        closeCallback(std::move(onClose))
+    {
+        signal = context->getLoop()->resource<uvw::AsyncHandle>();
+        signal->data(thisRef);
+
+        signal->on<uvw::AsyncEvent>(handleSignal);
+        signal->once<uvw::CloseEvent>(handleClose);
+    }
+
+    ConnectionHandOff::~ConnectionHandOff() {
+        if (signal) {
+            signal->clear();
+
+            if (!signal->closing()) {
+                signal->close();
+            }
+        }
+    }
+
+    void ConnectionHandOff::post(HttpConnection* connection, uv_os_sock_t socket) {
+        push(Item{connection, socket, nullptr});
+    }
+
+    void ConnectionHandOff::postStopped(IoWorker* worker) {
+        push(Item{nullptr, 0, worker});
+    }
+
+    void ConnectionHandOff::close() noexcept {
+        if (signal && !signal->closing()) {
+            signal->close();
+        }
+    }
+
+    void ConnectionHandOff::push(Item item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            items.push_back(item);
+        }
+
+        signal->send();
+    }
+
+    void ConnectionHandOff::drain() {
+        std::vector<Item> pending;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.swap(items);
+        }
+
+        for (const auto& item : pending) {
+            if (item.stoppedWorker) {
+                workerStoppedCallback(item.stoppedWorker);
+                continue;
+            }
+
+            auto client = context->getLoop()->resource<uvw::TCPHandle>();
+
+            item.connection->adopt(context, std::move(client), item.socket);
+        }
+    }
+
+    void ConnectionHandOff::handleSignal(const uvw::AsyncEvent&, uvw::AsyncHandle& handle) {
+        handle.data<ConnectionHandOff>()->drain();
+    }
+
+    void ConnectionHandOff::handleClose(const uvw::CloseEvent&, uvw::AsyncHandle& handle) {
+        auto handOff = handle.data<ConnectionHandOff>();
+
+        // The callback may destroy this instance
+        auto callback = std::move(handOff->closeCallback);
+
+        handOff->signal.reset();
+
+        if (callback) {
+            callback();
+        }
+    }
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <uvw.hpp>
+
+#include "commonHeaders.h"
+
+namespace nex {
+
+class HttpConnection;
+class IoWorker;
+class LoopContext;
+
+/**
+ * Carries connections and worker notifications from I/O threads to the main loop.
+ *
+ * Everything posted is handled on the main loop in posting order, so a worker's
+ * connections always arrive before its stop notification.
+ */
+class ConnectionHandOff {
+public:
+    typedef std::function<void(IoWorker* worker)> WorkerStoppedCallback;
+    typedef std::function<void()> CloseCallback;
+
+    ConnectionHandOff(
+        std::shared_ptr<LoopContext> mainContext,
+        WorkerStoppedCallback onWorkerStopped,
+        CloseCallback onClose
+    );
+    ConnectionHandOff(const ConnectionHandOff&) = delete;
+    ConnectionHandOff& operator=(const ConnectionHandOff&) = delete;
+    ~ConnectionHandOff();
+
+    /**
+     * Thread-safe, the connection must not be touched by the posting thread afterwards
+     */
+    void post(HttpConnection* connection, uv_os_sock_t socket);
+
+    /**
+     * Thread-safe, called by a worker once its loop has finished
+     */
+    void postStopped(IoWorker* worker);
+
+    /**
+     * Main loop only, must not be called before every worker has reported stopping
+     */
+    void close() noexcept;
+
+private:
+    struct Item {
+        HttpConnection* connection;
+        uv_os_sock_t socket;
+        IoWorker* stoppedWorker;
+    };
+
+    static void handleSignal(const uvw::AsyncEvent&, uvw::AsyncHandle& handle);
+    static void handleClose(const uvw::CloseEvent&, uvw::AsyncHandle& handle);
+
+    void push(Item item);
+    void drain();
+
+    std::shared_ptr<LoopContext> context;
+    std::shared_ptr<uvw::AsyncHandle> signal{nullptr};
+    std::shared_ptr<ConnectionHandOff> thisRef{this, noop<ConnectionHandOff>};
+
+    WorkerStoppedCallback workerStoppedCallback;
+    CloseCallback closeCallback;
+
+    std::mutex mutex;
+    std::vector<Item> items;
+};
+
+}
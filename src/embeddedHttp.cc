@@ -28,6 +28,7 @@ namespace nex {
         ErrorCallback onError
     ):
         loop(std::move(eventLoop)),
+        loopContext(std::make_shared<LoopContext>(loop, config)),
         config(std::move(config)),
         requestProcessor(std::move(requestProc)),
         errorCallback(std::move(onError)),
@@ -41,6 +42,13 @@ namespace nex {
         if (isClosing() || isShuttingDown())
             throw std::runtime_error("Server is closing or shutting down");
 
+        if (config->ioThreads) {
+            listenOnIoThreads(ip, port);
+            active = true;
+
+            return;
+        }
+
         setupTcpHandle();
 
         tcpHandle->bind(ip, port);
@@ -53,6 +61,16 @@ namespace nex {
         if (isClosing() || isShuttingDown())
             return;
 
+        if (!workers.empty()) {
+            shuttingDown = true;
+
+            for (auto& worker : workers) {
+                worker->stop();
+            }
+
+            return;
+        }
+
         if (tcpHandle) {
             if (isActive()) {
                 shuttingDown = true;
@@ -76,10 +94,81 @@ namespace nex {
         tcpHandle->on<uvw::CloseEvent>(handleClose);
     }
 
+    void EmbeddedHttp::listenOnIoThreads(const std::string& ip, uint32_t port) {
+        std::vector<std::unique_ptr<IoWorker>> newWorkers;
+
+        handOff = std::make_shared<ConnectionHandOff>(
+            loopContext,
+            [this](IoWorker* worker) { handleWorkerStopped(worker); },
+            [this]() { handleHandOffClose(); }
+        );
+
+        // app.set() keeps writing the shared config on the main thread, workers read a snapshot taken here
+        auto workerConfig = std::make_shared<HttpServerConfig>(*config);
+
+        try {
+            for (uint32_t i = 0; i < workerConfig->ioThreads; ++i) {
+                newWorkers.push_back(std::make_unique<IoWorker>(requestProcessor, isolate, workerConfig, handOff));
+                newWorkers.back()->bind(ip, port);
+            }
+        } catch (const std::exception&) {
+            newWorkers.clear();
+            handOff->close();
+            handOff.reset();
+
+            throw;
+        }
+
+        workers = std::move(newWorkers);
+
+        for (auto& worker : workers) {
+            worker->start();
+        }
+    }
+
+    void EmbeddedHttp::handleWorkerStopped(IoWorker* worker) {
+        for (auto it = workers.begin(); it != workers.end(); ++it) {
+            if (it->get() == worker) {
+                workers.erase(it);
+                break;
+            }
+        }
+
+        if (workers.empty()) {
+            handOff->close();
+        }
+    }
+
+    void EmbeddedHttp::handleHandOffClose() {
+        handOff.reset();
+
+        shuttingDown = false;
+        closing = false;
+        active = false;
+
+        if (deleterCalled_) {
+            delete this;
+        }
+    }
+
     bool EmbeddedHttp::isActive() const noexcept {
         return active;
     }
 
+    void EmbeddedHttp::getRouteCacheStats(uint64_t& hits, uint64_t& misses, uint64_t& evictions) const noexcept {
+        auto add = [&](const RouteCacheStats& stats) {
+            hits += stats.hits.load(std::memory_order_relaxed);
+            misses += stats.misses.load(std::memory_order_relaxed);
+            evictions += stats.evictions.load(std::memory_order_relaxed);
+        };
+
+        add(*loopContext->getRouteCache().getStats());
+
+        for (const auto& worker : workers) {
+            add(*worker->getRouteCacheStats());
+        }
+    }
+
     bool EmbeddedHttp::isClosing() const noexcept {
         return closing;
     }
@@ -93,8 +182,8 @@ namespace nex {
         auto http = server.data<EmbeddedHttp>();
         auto requestProc = http->requestProcessor;
 
-        [[maybe_unused]] auto httpConnection = new HttpConnection(
-            http->loop,
+        auto httpConnection = new HttpConnection(
+            http->loopContext,
             http->isolate,
             client,
             requestProc,
@@ -102,7 +191,7 @@ namespace nex {
         );
 
         server.accept(*client);
-        client->read();
+        httpConnection->startReading();
     }
 
     void EmbeddedHttp::handleServerError(const uvw::ErrorEvent &err, uvw::TCPHandle &server) {
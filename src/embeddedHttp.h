@@ -5,8 +5,11 @@
 #include "commonHeaders.h"
 
 #include "httpConfig.h"
+#include "loopContext.h"
 #include "abstractRequestProcessor.h"
+#include "connectionHandOff.h"
 #include "httpConnection.h"
+#include "ioWorker.h"
 
 namespace nex {
 
@@ -30,6 +33,11 @@ public:
 
     [[nodiscard]] bool isActive() const noexcept;
 
+    /**
+     * Sums the route cache counters of the main loop and the I/O threads
+     */
+    void getRouteCacheStats(uint64_t& hits, uint64_t& misses, uint64_t& evictions) const noexcept;
+
 private:
 
     explicit EmbeddedHttp(
@@ -45,6 +53,9 @@ private:
     [[nodiscard]] bool isShuttingDown() const noexcept;
 
     void setupTcpHandle();
+    void listenOnIoThreads(const std::string& ip, uint32_t port);
+    void handleWorkerStopped(IoWorker* worker);
+    void handleHandOffClose();
 
     static void handleConnection(const uvw::ListenEvent&, uvw::TCPHandle& server);
     static void handleServerError(const uvw::ErrorEvent& err, uvw::TCPHandle& server);
@@ -52,8 +63,11 @@ private:
     static void handleClose(const uvw::CloseEvent&, uvw::TCPHandle& server);
 
     std::shared_ptr<uvw::Loop> loop;
+    std::shared_ptr<LoopContext> loopContext;
     std::shared_ptr<uvw::TCPHandle> tcpHandle{nullptr};
     std::shared_ptr<EmbeddedHttp> thisRef{this, noop<EmbeddedHttp>};
+    std::shared_ptr<ConnectionHandOff> handOff{nullptr};
+    std::vector<std::unique_ptr<IoWorker>> workers;
     std::shared_ptr<HttpServerConfig> config;
 
     std::shared_ptr<AbstractRequestProcessor> requestProcessor;
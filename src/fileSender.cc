@@ -0,0 +1,194 @@
+#include "fileSender.h"
+
+#include <unistd.h>
+
+#include "httpConnection.h"
+#include "response.h"
+
+namespace nex {
+
+    // FileDescriptor
+
+    FileDescriptor::~FileDescriptor() {
+        if (fd >= 0) {
+            uv_fs_t req;
+
+            uv_fs_close(nullptr, &req, fd, nullptr);
+            uv_fs_req_cleanup(&req);
+        }
+    }
+
+    // FileSender
+
+    FileSender::FileSender(
+        std::shared_ptr<Response> response,
+        std::vector<FileSegment> segments,
+        CompletionCallback callback
+    ) : response(std::move(response)),
+        segments(std::move(segments)),
+        callback(std::move(callback))
+    {
+        req.data = this;
+    }
+
+    void FileSender::start() {
+        auto& connection = response->httpConnection;
+        uv_os_fd_t fd;
+
+        if (
+            !connection->client
+            || uv_fileno(reinterpret_cast<uv_handle_t*>(connection->client->raw()), &fd)
+            || (socket = dup(fd)) < 0
+        ) {
+            complete(false);
+            return;
+        }
+
+        loop = connection->loop;
+        flushThenSend();
+    }
+
+    void FileSender::flushThenSend() {
+        auto self = shared_from_this();
+
+        response->httpConnection->flush([self](int status) {
+            if (status || !self->response->isAlive) {
+                self->complete(false);
+                return;
+            }
+
+            self->sendNext();
+        });
+    }
+
+    void FileSender::sendNext() {
+        while (segmentIndex < segments.size() && !segments[segmentIndex].length && !segments[segmentIndex].data.length) {
+            ++segmentIndex;
+        }
+
+        if (segmentIndex == segments.size()) {
+            complete(true);
+            return;
+        }
+
+        auto& segment = segments[segmentIndex];
+
+        // Consecutive pieces of output, e.g. multipart delimiters, leave in one write
+        if (!segment.file) {
+            auto& output = response->httpConnection->output;
+
+            for (; segmentIndex < segments.size() && !segments[segmentIndex].file; ++segmentIndex) {
+                output.append(std::move(segments[segmentIndex].data));
+                segments[segmentIndex].data = OutputChunk();
+            }
+
+            flushThenSend();
+            return;
+        }
+
+        auto length = static_cast<size_t>(std::min(segment.length, maxSendfileLength));
+        auto err = uv_fs_sendfile(
+            loop->raw(), &req, socket, segment.file->get(), static_cast<int64_t>(segment.offset), length, handleSendfile
+        );
+
+        if (err) {
+            complete(false);
+            return;
+        }
+
+        pendingRef = shared_from_this();
+    }
+
+    void FileSender::readNext() {
+        auto& segment = segments[segmentIndex];
+
+        readBuffer.resize(static_cast<size_t>(std::min<uint64_t>(segment.length, fallbackBlockSize)));
+
+        auto buf = uv_buf_init(readBuffer.data(), static_cast<unsigned int>(readBuffer.size()));
+        auto err = uv_fs_read(
+            loop->raw(), &req, segment.file->get(), &buf, 1, static_cast<int64_t>(segment.offset), handleRead
+        );
+
+        if (err) {
+            complete(false);
+            return;
+        }
+
+        pendingRef = shared_from_this();
+    }
+
+    void FileSender::handleSendfile(uv_fs_t* req) {
+        auto sender = static_cast<FileSender*>(req->data);
+        auto self = std::move(sender->pendingRef);
+        auto result = req->result;
+
+        uv_fs_req_cleanup(req);
+
+        if (!sender->response->isAlive) {
+            sender->complete(false);
+            return;
+        }
+
+        if (result == UV_EAGAIN) {
+            sender->readNext();
+            return;
+        }
+
+        // Nothing sent without an error means the file got shorter than announced
+        if (result <= 0) {
+            sender->complete(false);
+            return;
+        }
+
+        sender->advance(static_cast<uint64_t>(result));
+        sender->sendNext();
+    }
+
+    void FileSender::handleRead(uv_fs_t* req) {
+        auto sender = static_cast<FileSender*>(req->data);
+        auto self = std::move(sender->pendingRef);
+        auto result = req->result;
+
+        uv_fs_req_cleanup(req);
+
+        if (!sender->response->isAlive || result <= 0) {
+            sender->complete(false);
+            return;
+        }
+
+        sender->readBuffer.resize(static_cast<size_t>(result));
+        sender->advance(static_cast<uint64_t>(result));
+        sender->response->httpConnection->output.append(OutputChunk::take(std::move(sender->readBuffer)));
+        sender->readBuffer = std::string();
+        sender->flushThenSend();
+    }
+
+    void FileSender::advance(uint64_t bytes) noexcept {
+        auto& segment = segments[segmentIndex];
+
+        segment.offset += bytes;
+        segment.length -= std::min(bytes, segment.length);
+    }
+
+    void FileSender::complete(bool sent) {
+        if (completed) {
+            return;
+        }
+
+        completed = true;
+
+        if (socket >= 0) {
+            ::close(socket);
+            socket = -1;
+        }
+
+        auto completionCallback = std::move(callback);
+
+        callback = nullptr;
+        segments.clear();
+        response.reset();
+
+        completionCallback(sent);
+    }
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <uvw.hpp>
+
+#include "commonHeaders.h"
+#include "outputBatch.h"
+
+namespace nex {
+
+class Response;
+
+/**
+ * Open file descriptor shared by the cache and the responses sending it, closed with the last of them.
+ */
+class FileDescriptor {
+public:
+    explicit FileDescriptor(uv_file fd) noexcept : fd(fd) {}
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+    ~FileDescriptor();
+
+    [[nodiscard]] uv_file get() const noexcept { return fd; }
+
+private:
+    uv_file fd;
+};
+
+/**
+ * Byte range of a file, or a piece of output when `file` is null
+ */
+struct FileSegment {
+    std::shared_ptr<const FileDescriptor> file{nullptr};
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    OutputChunk data;
+};
+
+/**
+ * Writes file ranges to the socket of a response with sendfile(2), once the output queued before
+ * them has left. The socket is non-blocking, so whenever it is full one block is read and queued
+ * as a regular write instead, sendfile resumes after that write drains.
+ */
+class FileSender : public std::enable_shared_from_this<FileSender> {
+public:
+    typedef std::function<void(bool)> CompletionCallback;
+
+    FileSender(std::shared_ptr<Response> response, std::vector<FileSegment> segments, CompletionCallback callback);
+    FileSender(const FileSender&) = delete;
+    FileSender& operator=(const FileSender&) = delete;
+
+    void start();
+
+private:
+    // A single sendfile call is capped, so that one response can't hold a threadpool thread for long
+    static constexpr uint64_t maxSendfileLength = 4 * 1024 * 1024;
+    static constexpr size_t fallbackBlockSize = 64 * 1024;
+
+    static void handleSendfile(uv_fs_t* req);
+    static void handleRead(uv_fs_t* req);
+
+    void flushThenSend();
+    void sendNext();
+    void readNext();
+    void advance(uint64_t bytes) noexcept;
+    void complete(bool sent);
+
+    std::shared_ptr<Response> response;
+    std::shared_ptr<uvw::Loop> loop{nullptr};
+    std::vector<FileSegment> segments;
+    CompletionCallback callback;
+
+    uv_fs_t req{};
+    // Keeps the sender alive while a request of the threadpool is in flight
+    std::shared_ptr<FileSender> pendingRef{nullptr};
+    std::string readBuffer;
+
+    size_t segmentIndex = 0;
+    // A duplicate of the socket, it can't be closed and reused under a running sendfile
+    uv_os_fd_t socket = -1;
+    bool completed = false;
+};
+
+}
@@ -0,0 +1,81 @@
+#include "headerCache.h"
+
+namespace nex {
+
+    HeaderCache::HeaderCache(std::shared_ptr<HttpServerConfig> configuration)
+        : config(std::move(configuration)) {}
+
+    std::string_view HeaderCache::getDateLine() {
+        // Loop time only says how long ago the line was rendered, not whether the second has changed
+        auto now = time(nullptr);
+
+        if (!dateRendered || now != dateRenderedAt) {
+            dateRendered = true;
+            dateRenderedAt = now;
+            dateLine = "Date: " + getStandardizedTime(now) + "\r\n";
+        }
+
+        return dateLine;
+    }
+
+    std::string_view HeaderCache::getConnectionLines() {
+        // Settings of the main loop may still change after listen(), re-render only when they did
+        if (
+            !connectionLinesRendered
+            || renderedPersistent != config->persistentConnections
+            || renderedKeepAliveTimeout != config->keepAliveTimeout
+            || renderedMaxRequests != config->maxRequestsPerConnection
+        ) {
+            renderConnectionLines();
+        }
+
+        return connectionLines;
+    }
+
+    std::string_view HeaderCache::getStatusLine(uint32_t minorVersion, uint32_t statusCode) {
+        if (minorVersion > 1 || statusCode < minStatusCode || statusCode > maxStatusCode) {
+            uncachedStatusLine = "HTTP/1." + std::to_string(minorVersion) + " " + std::to_string(statusCode) +
+                    " " + getStatusTextByCode(statusCode) + "\r\n";
+
+            return uncachedStatusLine;
+        }
+
+        auto& line = statusLines[minorVersion * (maxStatusCode - minStatusCode + 1) + statusCode - minStatusCode];
+
+        if (line.empty()) {
+            line = "HTTP/1." + std::to_string(minorVersion) + " " + std::to_string(statusCode) +
+                    " " + getStatusTextByCode(statusCode) + "\r\n";
+        }
+
+        return line;
+    }
+
+    std::string HeaderCache::getDateValue() {
+        auto line = getDateLine();
+
+        return std::string(line.substr(6, line.length() - 8));
+    }
+
+    std::string HeaderCache::getConnectionValue() {
+        return config->persistentConnections ? "keep-alive" : "close";
+    }
+
+    std::string HeaderCache::getKeepAliveValue() {
+        return "timeout=" + std::to_string(config->keepAliveTimeout / 1000) +
+                ", max=" + std::to_string(config->maxRequestsPerConnection);
+    }
+
+    void HeaderCache::renderConnectionLines() {
+        connectionLinesRendered = true;
+        renderedPersistent = config->persistentConnections;
+        renderedKeepAliveTimeout = config->keepAliveTimeout;
+        renderedMaxRequests = config->maxRequestsPerConnection;
+
+        connectionLines = "Connection: " + getConnectionValue() + "\r\n";
+
+        if (renderedPersistent) {
+            connectionLines += "Keep-Alive: " + getKeepAliveValue() + "\r\n";
+        }
+    }
+
+}
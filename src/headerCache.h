@@ -0,0 +1,58 @@
+#pragma once
+
+#include <uvw.hpp>
+
+#include "commonHeaders.h"
+#include "httpConfig.h"
+
+namespace nex {
+
+/**
+ * Pre-serialized response header fragments shared by all responses of one event loop.
+ */
+class HeaderCache {
+public:
+    explicit HeaderCache(std::shared_ptr<HttpServerConfig> config);
+
+    /**
+     * `Date: ...\r\n`, re-rendered when the wall-clock second changes
+     */
+    std::string_view getDateLine();
+
+    /**
+     * `Connection: ...\r\n` and, for persistent connections, `Keep-Alive: ...\r\n`
+     */
+    std::string_view getConnectionLines();
+
+    /**
+     * `HTTP/1.x NNN Text\r\n`
+     */
+    std::string_view getStatusLine(uint32_t minorVersion, uint32_t statusCode);
+
+    [[nodiscard]] std::string getDateValue();
+    [[nodiscard]] std::string getConnectionValue();
+    [[nodiscard]] std::string getKeepAliveValue();
+
+private:
+    static constexpr uint32_t minStatusCode = 100;
+    static constexpr uint32_t maxStatusCode = 599;
+
+    void renderConnectionLines();
+
+    std::shared_ptr<HttpServerConfig> config;
+
+    std::string dateLine;
+    time_t dateRenderedAt = 0;
+    bool dateRendered = false;
+
+    std::string connectionLines;
+    uint32_t renderedKeepAliveTimeout = 0;
+    uint32_t renderedMaxRequests = 0;
+    bool renderedPersistent = false;
+    bool connectionLinesRendered = false;
+
+    std::array<std::string, 2 * (maxStatusCode - minStatusCode + 1)> statusLines;
+    std::string uncachedStatusLine;
+};
+
+}
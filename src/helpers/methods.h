@@ -4,6 +4,7 @@
 #define NEXPRESS_METHODS_H
 
 #include <string>
+#include <string_view>
 #include <exception>
 
 namespace nex {
@@ -61,11 +62,36 @@ namespace nex {
         UNLOCK, UNSUBSCRIBE
     };
 
-    inline HttpMethod parseMethod(const std::string& method) {
+    constexpr size_t HTTP_METHODS_COUNT = sizeof(ALL_HTTP_METHODS) / sizeof(ALL_HTTP_METHODS[0]);
+
+    /**
+     * Position of the method in ALL_HTTP_METHODS, HTTP_METHODS_COUNT for ALL and unknown values
+     */
+    inline size_t getMethodIndex(HttpMethod method) noexcept {
+        for (size_t i = 0; i < HTTP_METHODS_COUNT; ++i) {
+            if (ALL_HTTP_METHODS[i] == method) {
+                return i;
+            }
+        }
+
+        return HTTP_METHODS_COUNT;
+    }
+
+    constexpr unsigned int str2int(std::string_view str) {
+        unsigned int h = 5381U;
+
+        for (auto i = str.length(); i > 0; --i) {
+            h = (h * 33U) ^ static_cast<unsigned char>(str[i - 1]);
+        }
+
+        return h;
+    }
+
+    inline bool tryParseMethod(std::string_view method, HttpMethod& result) noexcept {
         const char * ret = nullptr;
         HttpMethod retMethod;
 
-        switch (str2int(method.c_str())) {
+        switch (str2int(method)) {
 
             case HttpMethod::ACL:
                 ret = "ACL";
@@ -238,10 +264,20 @@ namespace nex {
                 break;
         }
 
-        if (ret == nullptr || ::strcmp(ret, method.c_str()) != 0)
+        if (ret == nullptr || method != ret)
+            return false;
+
+        result = retMethod;
+        return true;
+    }
+
+    inline HttpMethod parseMethod(const std::string& method) {
+        HttpMethod result;
+
+        if (!tryParseMethod(method, result))
             throw std::runtime_error("Unknown HTTP Method");
 
-        return retMethod;
+        return result;
     }
 
     inline std::string methodToString(HttpMethod method) {
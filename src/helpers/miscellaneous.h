@@ -5,6 +5,7 @@
 
 #include <ctime>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <algorithm>
 
@@ -15,7 +16,9 @@ namespace nex {
 
     inline std::string getStandardizedTime(time_t value) {
         char buf[50];
-        tm ts = *gmtime(&value);
+        tm ts{};
+        // Loops of I/O threads render dates concurrently, gmtime() shares one buffer between them
+        gmtime_r(&value, &ts);
         strftime(buf, sizeof buf, "%a, %d %b %Y %H:%M:%S GMT", &ts);
 
         return std::string(buf);
@@ -25,6 +28,52 @@ namespace nex {
         return getStandardizedTime(time(nullptr));
     }
 
+    /**
+     * Parses the format of getStandardizedTime, e.g. `Sun, 06 Nov 1994 08:49:37 GMT`
+     */
+    inline bool parseStandardizedTime(std::string_view value, time_t& result) {
+        constexpr std::string_view months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+        if (value.length() != 29 || value[3] != ',' || value.substr(25) != " GMT") {
+            return false;
+        }
+
+        auto readNumber = [value](size_t position, size_t length, int& number) {
+            number = 0;
+
+            for (auto i = position; i < position + length; ++i) {
+                if (value[i] < '0' || value[i] > '9') {
+                    return false;
+                }
+
+                number = number * 10 + (value[i] - '0');
+            }
+
+            return true;
+        };
+
+        auto month = months.find(value.substr(8, 3));
+        tm ts{};
+
+        if (
+            month == std::string_view::npos || month % 3
+            || !readNumber(5, 2, ts.tm_mday)
+            || !readNumber(12, 4, ts.tm_year)
+            || value[19] != ':' || value[22] != ':'
+            || !readNumber(17, 2, ts.tm_hour)
+            || !readNumber(20, 2, ts.tm_min)
+            || !readNumber(23, 2, ts.tm_sec)
+        ) {
+            return false;
+        }
+
+        ts.tm_mon = static_cast<int>(month / 3);
+        ts.tm_year -= 1900;
+        result = timegm(&ts);
+
+        return true;
+    }
+
     inline void readBytesFromStream(std::istream &stream, std::string::size_type count, std::string& out) {
         if (!count) {
             return;
@@ -122,6 +171,57 @@ namespace nex {
         }
     };
 
+    /**
+     * Strips the spaces and tabs HTTP allows around header values and list items
+     */
+    inline std::string_view trim(std::string_view value) noexcept {
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+            value.remove_prefix(1);
+        }
+
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+            value.remove_suffix(1);
+        }
+
+        return value;
+    }
+
+    inline bool equalsCaseInsensitive(std::string_view first, std::string_view second) {
+        if (first.length() != second.length()) {
+            return false;
+        }
+
+        for (size_t i = 0; i < first.length(); ++i) {
+            if (tolower(static_cast<unsigned char>(first[i])) != tolower(static_cast<unsigned char>(second[i]))) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Orders an already lowercased string against another one compared in lowercase
+     */
+    inline int compareLowercase(std::string_view lowercased, std::string_view other) noexcept {
+        auto length = std::min(lowercased.length(), other.length());
+
+        for (size_t i = 0; i < length; ++i) {
+            auto first = static_cast<unsigned char>(lowercased[i]);
+            auto second = static_cast<unsigned char>(tolower(static_cast<unsigned char>(other[i])));
+
+            if (first != second) {
+                return first < second ? -1 : 1;
+            }
+        }
+
+        if (lowercased.length() == other.length()) {
+            return 0;
+        }
+
+        return lowercased.length() < other.length() ? -1 : 1;
+    }
+
     inline void stringToLower(std::string& str) {
         std::transform(str.begin(), str.end(), str.begin(),
                        [](unsigned char c){ return std::tolower(c); });
@@ -0,0 +1,811 @@
+#include "http2Connection.h"
+
+#include <limits>
+
+#include "httpConnection.h"
+
+namespace nex {
+
+    namespace {
+        /**
+         * Hop-by-hop headers of HTTP/1, a peer has to treat them as malformed in HTTP/2
+         */
+        bool isConnectionSpecific(std::string_view name) noexcept {
+            return equalsCaseInsensitive(name, "Connection")
+                || equalsCaseInsensitive(name, "Keep-Alive")
+                || equalsCaseInsensitive(name, "Proxy-Connection")
+                || equalsCaseInsensitive(name, "Transfer-Encoding")
+                || equalsCaseInsensitive(name, "Upgrade");
+        }
+
+        uint64_t getRemainingLength(const FileSegment& segment) noexcept {
+            return segment.file ? segment.length : segment.data.length;
+        }
+
+        nghttp2_nv makeNv(const std::string& name, const std::string& value) noexcept {
+            return nghttp2_nv{
+                reinterpret_cast<uint8_t*>(const_cast<char*>(name.data())),
+                reinterpret_cast<uint8_t*>(const_cast<char*>(value.data())),
+                name.length(),
+                value.length(),
+                NGHTTP2_NV_FLAG_NONE
+            };
+        }
+    }
+
+    // Http2Stream
+
+    Http2Stream::Http2Stream(Http2Connection* session, int32_t id) noexcept
+        : session(session), id(id)
+    {}
+
+    void Http2Stream::setHeaders(uint32_t statusCode, const HeaderMapping& headers, std::string_view date) {
+        bool hasDate = false;
+
+        responseHeaders.clear();
+        responseHeaders.emplace_back(":status", std::to_string(statusCode));
+
+        for (const auto& [name, value] : headers) {
+            if (isConnectionSpecific(name)) {
+                continue;
+            }
+
+            // Field names are lowercase on the wire
+            auto lowercaseName = name;
+            stringToLower(lowercaseName);
+
+            if (lowercaseName == "date") {
+                hasDate = true;
+            }
+
+            if (auto ref = std::get_if<std::string>(&value)) {
+                responseHeaders.emplace_back(lowercaseName, *ref);
+                continue;
+            }
+
+            if (auto ref = std::get_if<std::vector<std::string>>(&value)) {
+                for (auto& v : *ref) {
+                    responseHeaders.emplace_back(lowercaseName, v);
+                }
+            }
+        }
+
+        if (!hasDate) {
+            responseHeaders.emplace_back("date", std::string(date));
+        }
+
+        headersReady = true;
+    }
+
+    void Http2Stream::write(OutputChunk data) {
+        write(FileSegment{nullptr, 0, 0, std::move(data)});
+    }
+
+    void Http2Stream::write(FileSegment segment) {
+        if (!session || ended || !getRemainingLength(segment)) {
+            return;
+        }
+
+        pending.push_back(std::move(segment));
+    }
+
+    void Http2Stream::flush() {
+        if (!session) {
+            return;
+        }
+
+        session->commit(*this);
+    }
+
+    void Http2Stream::end() {
+        if (!session || ended) {
+            return;
+        }
+
+        ended = true;
+        session->commit(*this);
+    }
+
+    void Http2Stream::handleRequestTimeout(TimerEntry& timer) {
+        auto stream = timer.getData<Http2Stream>();
+
+        if (stream->session) {
+            stream->session->timeOutRequest(*stream);
+        }
+    }
+
+    void Http2Stream::handleResponseTimeout(TimerEntry& timer) {
+        auto response = timer.getData<Http2Stream>()->response;
+
+        if (!response) {
+            return;
+        }
+
+        response->setStatus(500);
+        response->end();
+    }
+
+    bool Http2Stream::readAhead() {
+        auto& segment = pending.front();
+
+        readBuffer.resize(static_cast<size_t>(std::min<uint64_t>(segment.length, readAheadLength)));
+        readRequest.data = this;
+
+        auto buffer = uv_buf_init(readBuffer.data(), static_cast<unsigned int>(readBuffer.size()));
+        auto err = uv_fs_read(
+                session->getLoop(),
+                &readRequest,
+                segment.file->get(),
+                &buffer,
+                1,
+                static_cast<int64_t>(segment.offset),
+                handleRead
+        );
+
+        if (err) {
+            readBuffer = std::string();
+            return false;
+        }
+
+        reading = true;
+        readFile = segment.file;
+        pendingRef = shared_from_this();
+
+        return true;
+    }
+
+    void Http2Stream::handleRead(uv_fs_t* req) {
+        auto stream = static_cast<Http2Stream*>(req->data);
+        auto self = std::move(stream->pendingRef);
+        auto result = req->result;
+        auto data = std::move(stream->readBuffer);
+
+        uv_fs_req_cleanup(req);
+
+        stream->reading = false;
+        stream->readFile = nullptr;
+        stream->readBuffer = std::string();
+
+        // The stream was closed while the block was read
+        auto connection = stream->session;
+
+        if (!connection) {
+            return;
+        }
+
+        // Nothing read means the file got shorter than announced
+        if (result <= 0) {
+            nghttp2_submit_rst_stream(connection->session, NGHTTP2_FLAG_NONE, stream->id, NGHTTP2_INTERNAL_ERROR);
+            connection->send();
+            return;
+        }
+
+        auto& segment = stream->pending.front();
+        auto bytesRead = static_cast<uint64_t>(result);
+
+        data.resize(static_cast<size_t>(bytesRead));
+        segment.offset += bytesRead;
+        segment.length -= std::min(segment.length, bytesRead);
+
+        if (!segment.length) {
+            stream->pending.pop_front();
+        }
+
+        stream->pending.push_front(FileSegment{nullptr, 0, 0, OutputChunk::take(std::move(data))});
+        connection->commit(*stream);
+    }
+
+    // Http2Connection
+
+    Http2Connection::Http2Connection(HttpConnection& connection)
+        : connection(connection)
+    {
+        nghttp2_session_callbacks* callbacks;
+
+        if (nghttp2_session_callbacks_new(&callbacks) != 0) {
+            throw std::runtime_error("Couldn't allocate nghttp2 callbacks");
+        }
+
+        nghttp2_session_callbacks_set_on_begin_headers_callback(callbacks, handleBeginHeaders);
+        nghttp2_session_callbacks_set_on_header_callback(callbacks, handleHeader);
+        nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks, handleFrame);
+        nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks, handleDataChunk);
+        nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, handleStreamClose);
+        nghttp2_session_callbacks_set_send_data_callback(callbacks, sendData);
+
+        auto result = nghttp2_session_server_new(&session, callbacks, this);
+
+        nghttp2_session_callbacks_del(callbacks);
+
+        if (result != 0) {
+            throw std::runtime_error("Couldn't create HTTP/2 session");
+        }
+
+        nghttp2_settings_entry settings[] = {
+            {NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, connection.config->http2MaxConcurrentStreams},
+        };
+
+        nghttp2_submit_settings(session, NGHTTP2_FLAG_NONE, settings, 1);
+    }
+
+    Http2Connection::~Http2Connection() {
+        terminated = true;
+
+        auto open = std::move(streams);
+
+        streams.clear();
+
+        for (auto& [id, stream] : open) {
+            closeStream(*stream);
+        }
+
+        nghttp2_session_del(session);
+    }
+
+    PrefaceMatch Http2Connection::matchPreface(std::string_view data) noexcept {
+        std::string_view preface(NGHTTP2_CLIENT_MAGIC, NGHTTP2_CLIENT_MAGIC_LEN);
+        auto length = std::min(data.length(), preface.length());
+
+        if (data.substr(0, length) != preface.substr(0, length)) {
+            return PrefaceMatch::None;
+        }
+
+        return length == preface.length() ? PrefaceMatch::Complete : PrefaceMatch::Partial;
+    }
+
+    bool Http2Connection::receive(std::string_view data) {
+        receiving = true;
+
+        auto result = nghttp2_session_mem_recv(
+                session,
+                reinterpret_cast<const uint8_t*>(data.data()),
+                data.length()
+        );
+
+        receiving = false;
+
+        // Protocol errors of the peer come back as a queued GOAWAY, negative results are fatal
+        if (result < 0) {
+            return false;
+        }
+
+        send();
+
+        return true;
+    }
+
+    void Http2Connection::terminate() {
+        if (terminated) {
+            return;
+        }
+
+        terminated = true;
+
+        nghttp2_session_terminate_session(session, NGHTTP2_NO_ERROR);
+
+        if (!receiving) {
+            (void) writeFrames();
+        }
+
+        auto open = std::move(streams);
+
+        streams.clear();
+
+        for (auto& [id, stream] : open) {
+            closeStream(*stream);
+        }
+    }
+
+    std::shared_ptr<Http2Stream> Http2Connection::findStream(int32_t streamId) const {
+        auto it = streams.find(streamId);
+
+        return it != streams.end() ? it->second : nullptr;
+    }
+
+    uv_loop_t* Http2Connection::getLoop() const noexcept {
+        return connection.loop->raw();
+    }
+
+    void Http2Connection::startRequestTimer(Http2Stream& stream) {
+        if (!connection.config->requestTimeout) {
+            return;
+        }
+
+        connection.context->getTimerWheel().arm(stream.requestTimer, connection.config->requestTimeout);
+    }
+
+    void Http2Connection::stopRequestTimer(Http2Stream& stream) noexcept {
+        connection.context->getTimerWheel().disarm(stream.requestTimer);
+    }
+
+    void Http2Connection::timeOutRequest(Http2Stream& stream) {
+        auto req = stream.request;
+        auto res = stream.response;
+
+        // Like on HTTP/1 the request is answered with 408, a peer that still doesn't finish it loses the stream
+        if (!stream.requestTimedOut && req && res && res->isAlive && !res->headersSent) {
+            stream.requestTimedOut = true;
+            stream.discardBody = true;
+            startRequestTimer(stream);
+
+            res->setStatus(408);
+            req->handleDataEnd();
+            res->end();
+            return;
+        }
+
+        nghttp2_submit_rst_stream(session, NGHTTP2_FLAG_NONE, stream.id, NGHTTP2_CANCEL);
+        send();
+    }
+
+    void Http2Connection::startRequest(const std::shared_ptr<Http2Stream>& stream, bool endStream) {
+        std::shared_ptr<Request> req;
+        HttpMethod method;
+        auto errorCode = stream->requestError;
+
+        if (!errorCode && (stream->path.empty() || stream->method.empty())) {
+            errorCode = 400;
+        }
+
+        if (!errorCode && !tryParseMethod(stream->method, method)) {
+            errorCode = 405;
+        }
+
+        if (errorCode) {
+            req = connection.createRequest(errorCode);
+        } else {
+            auto& block = stream->headerBlock;
+            auto& spans = stream->headerSpans;
+
+            // Cookie fields may come split, they are joined back for the HTTP/1 style parsing
+            if (!stream->cookies.empty()) {
+                spans.push_back({block.length(), 6, block.length() + 8, stream->cookies.length()});
+                block.append("cookie: ").append(stream->cookies).append(CRLF);
+            }
+
+            if (!stream->authority.empty()) {
+                spans.push_back({block.length(), 4, block.length() + 6, stream->authority.length()});
+                block.append("host: ").append(stream->authority).append(CRLF);
+            }
+
+            std::vector<phr_header> headers(spans.size());
+
+            for (size_t i = 0; i < spans.size(); ++i) {
+                headers[i] = phr_header{
+                    block.data() + spans[i].nameOffset,
+                    spans[i].nameLength,
+                    block.data() + spans[i].valueOffset,
+                    spans[i].valueLength
+                };
+            }
+
+            req = connection.createRequest(block, headers.data(), headers.size(), stream->path, method, 1);
+
+            if (stream->path.length() > connection.config->maxPathLength) {
+                req->requestError = 414;
+            }
+
+            if (req->headers.has(KnownHeader::ContentLength)) {
+                uint64_t contentLength;
+                auto contentLengthRaw = req->headers.get(KnownHeader::ContentLength);
+                auto contentLengthEnd = contentLengthRaw.data() + contentLengthRaw.length();
+                auto [contentLengthParsed, error] = std::from_chars(
+                        contentLengthRaw.data(), contentLengthEnd, contentLength
+                );
+
+                if (error != std::errc() || contentLengthParsed != contentLengthEnd) {
+                    req->requestError = 411;
+                } else if (contentLength > connection.config->maxRequestBodyLength) {
+                    req->requestError = 413;
+                } else {
+                    req->contentLength = static_cast<uint32_t>(contentLength);
+                }
+            } else if (!endStream) {
+                // The body ends with the stream, DATA frames are counted against the limit instead
+                req->contentLength = std::numeric_limits<uint32_t>::max();
+            }
+
+            if (endStream) {
+                req->isFullData = true;
+            }
+        }
+
+        stream->headerBlock = std::string();
+        stream->headerSpans = std::vector<Http2Stream::HeaderSpan>();
+
+        if (endStream) {
+            stopRequestTimer(*stream);
+        } else {
+            startRequestTimer(*stream);
+        }
+
+        auto res = connection.createResponse(req);
+
+        res->stream = stream;
+        stream->request = req;
+        stream->response = res;
+
+        if (req->requestError) {
+            res->end();
+            return;
+        }
+
+        if (connection.config->responseTimeout) {
+            connection.context->getTimerWheel().arm(stream->responseTimer, connection.config->responseTimeout);
+        }
+
+        connection.requestProcessor->process(req, res);
+    }
+
+    void Http2Connection::receiveBody(Http2Stream& stream, std::string_view data) {
+        auto req = stream.request;
+
+        if (!req || stream.discardBody) {
+            return;
+        }
+
+        if (req->bodyOctetsReceived + data.length() > connection.config->maxRequestBodyLength) {
+            auto res = stream.response;
+
+            if (res && res->isAlive && !res->headersSent) {
+                res->setStatus(413);
+                res->end();
+            } else {
+                nghttp2_submit_rst_stream(session, NGHTTP2_FLAG_NONE, stream.id, NGHTTP2_CANCEL);
+            }
+
+            stream.discardBody = true;
+            req->handleDataEnd();
+            return;
+        }
+
+        req->handleData(data);
+    }
+
+    void Http2Connection::endRequestBody(Http2Stream& stream) {
+        auto req = stream.request;
+
+        stopRequestTimer(stream);
+
+        if (!req || stream.discardBody) {
+            return;
+        }
+
+        req->isFullData = true;
+        req->handleDataEnd();
+    }
+
+    void Http2Connection::closeStream(Http2Stream& stream) {
+        auto req = std::move(stream.request);
+        auto res = std::move(stream.response);
+
+        // Detached first, invalidation may call back into a handler that writes to the response
+        stream.session = nullptr;
+        stream.pending.clear();
+        stopRequestTimer(stream);
+        connection.context->getTimerWheel().disarm(stream.responseTimer);
+
+        if (req) {
+            req->invalidate();
+        }
+
+        if (res) {
+            res->invalidate();
+        }
+
+        if (streams.empty() && !terminated) {
+            connection.startKeepAliveTimer();
+        }
+    }
+
+    void Http2Connection::commit(Http2Stream& stream) {
+        if (stream.ended) {
+            connection.context->getTimerWheel().disarm(stream.responseTimer);
+        }
+
+        if (!stream.submitted) {
+            if (!stream.headersReady) {
+                return;
+            }
+
+            std::vector<nghttp2_nv> nv;
+            nghttp2_data_provider provider{};
+
+            nv.reserve(stream.responseHeaders.size());
+
+            for (const auto& [name, value] : stream.responseHeaders) {
+                nv.push_back(makeNv(name, value));
+            }
+
+            provider.source.ptr = &stream;
+            provider.read_callback = readData;
+
+            // A response without a body ends the stream with its HEADERS frame
+            auto hasBody = !stream.ended || !stream.pending.empty();
+
+            if (nghttp2_submit_response(session, stream.id, nv.data(), nv.size(), hasBody ? &provider : nullptr)) {
+                nghttp2_submit_rst_stream(session, NGHTTP2_FLAG_NONE, stream.id, NGHTTP2_INTERNAL_ERROR);
+            }
+
+            stream.responseHeaders = std::vector<std::pair<std::string, std::string>>();
+            stream.submitted = true;
+        } else if (stream.deferred && (stream.ended || !stream.pending.empty())) {
+            stream.deferred = false;
+            nghttp2_session_resume_data(session, stream.id);
+        }
+
+        send();
+    }
+
+    void Http2Connection::send() {
+        if (receiving) {
+            return;
+        }
+
+        auto written = writeFrames();
+
+        connection.scheduleFlush();
+
+        if (terminated) {
+            return;
+        }
+
+        if (!written || (!nghttp2_session_want_read(session) && !nghttp2_session_want_write(session))) {
+            connection.close();
+        }
+    }
+
+    bool Http2Connection::writeFrames() {
+        while (true) {
+            const uint8_t* data = nullptr;
+            auto length = nghttp2_session_mem_send(session, &data);
+
+            if (length < 0) {
+                return false;
+            }
+
+            if (length == 0) {
+                return true;
+            }
+
+            // Control frames are small, the buffer is reused by the next call
+            connection.output.append(std::string(reinterpret_cast<const char*>(data), static_cast<size_t>(length)));
+        }
+    }
+
+    int Http2Connection::handleBeginHeaders(nghttp2_session*, const nghttp2_frame* frame, void* userData) {
+        auto self = static_cast<Http2Connection*>(userData);
+
+        if (frame->hd.type != NGHTTP2_HEADERS || frame->headers.cat != NGHTTP2_HCAT_REQUEST) {
+            return 0;
+        }
+
+        auto streamId = frame->hd.stream_id;
+
+        auto stream = std::make_shared<Http2Stream>(self, streamId);
+
+        self->connection.stopKeepAliveTimer();
+        self->streams[streamId] = stream;
+        // Without it a peer that never finishes the headers would hold the connection forever
+        self->startRequestTimer(*stream);
+
+        return 0;
+    }
+
+    int Http2Connection::handleHeader(
+            nghttp2_session*,
+            const nghttp2_frame* frame,
+            const uint8_t* name,
+            size_t nameLength,
+            const uint8_t* value,
+            size_t valueLength,
+            uint8_t,
+            void* userData
+    ) {
+        auto self = static_cast<Http2Connection*>(userData);
+
+        // Trailers are dropped, like an HTTP/1 request can't have any
+        if (frame->hd.type != NGHTTP2_HEADERS || frame->headers.cat != NGHTTP2_HCAT_REQUEST) {
+            return 0;
+        }
+
+        auto stream = self->findStream(frame->hd.stream_id);
+
+        if (!stream) {
+            return 0;
+        }
+
+        std::string_view fieldName(reinterpret_cast<const char*>(name), nameLength);
+        std::string_view fieldValue(reinterpret_cast<const char*>(value), valueLength);
+
+        self->startRequestTimer(*stream);
+
+        // Pseudo-headers and cookies are kept apart from the block, they count against its limit all the same
+        auto headersLength = stream->headerBlock.length() + stream->method.length() + stream->path.length()
+            + stream->authority.length() + stream->cookies.length();
+
+        if (headersLength + nameLength + valueLength + 4 > maxHeaderBlockLength) {
+            stream->requestError = 413;
+            return 0;
+        }
+
+        // nghttp2 has checked the pseudo-headers of a request by now
+        if (fieldName == ":method") {
+            stream->method = fieldValue;
+            return 0;
+        }
+
+        if (fieldName == ":path") {
+            stream->path = fieldValue;
+            return 0;
+        }
+
+        if (fieldName == ":authority") {
+            stream->authority = fieldValue;
+            return 0;
+        }
+
+        if (!fieldName.empty() && fieldName[0] == ':') {
+            return 0;
+        }
+
+        if (fieldName == "host" && !stream->authority.empty()) {
+            return 0;
+        }
+
+        if (fieldName == "cookie") {
+            if (!stream->cookies.empty()) {
+                stream->cookies.append("; ");
+            }
+
+            stream->cookies.append(fieldValue);
+            return 0;
+        }
+
+        auto& block = stream->headerBlock;
+
+        if (stream->headerSpans.size() >= HttpConnection::maxHeadersCount) {
+            stream->requestError = 400;
+            return 0;
+        }
+
+        stream->headerSpans.push_back({block.length(), nameLength, block.length() + nameLength + 2, valueLength});
+        block.append(fieldName).append(": ").append(fieldValue).append(CRLF);
+
+        return 0;
+    }
+
+    int Http2Connection::handleFrame(nghttp2_session*, const nghttp2_frame* frame, void* userData) {
+        auto self = static_cast<Http2Connection*>(userData);
+        auto endStream = (frame->hd.flags & NGHTTP2_FLAG_END_STREAM) != 0;
+
+        if (frame->hd.type != NGHTTP2_HEADERS && frame->hd.type != NGHTTP2_DATA) {
+            return 0;
+        }
+
+        auto stream = self->findStream(frame->hd.stream_id);
+
+        if (!stream) {
+            return 0;
+        }
+
+        if (frame->hd.type == NGHTTP2_HEADERS && frame->headers.cat == NGHTTP2_HCAT_REQUEST) {
+            self->startRequest(stream, endStream);
+            return 0;
+        }
+
+        if (endStream) {
+            self->endRequestBody(*stream);
+        }
+
+        return 0;
+    }
+
+    int Http2Connection::handleDataChunk(
+            nghttp2_session*,
+            uint8_t,
+            int32_t streamId,
+            const uint8_t* data,
+            size_t length,
+            void* userData
+    ) {
+        auto self = static_cast<Http2Connection*>(userData);
+        auto stream = self->findStream(streamId);
+
+        if (stream) {
+            self->startRequestTimer(*stream);
+            self->receiveBody(*stream, std::string_view(reinterpret_cast<const char*>(data), length));
+        }
+
+        return 0;
+    }
+
+    int Http2Connection::handleStreamClose(nghttp2_session*, int32_t streamId, uint32_t, void* userData) {
+        auto self = static_cast<Http2Connection*>(userData);
+        auto it = self->streams.find(streamId);
+
+        if (it == self->streams.end()) {
+            return 0;
+        }
+
+        auto stream = std::move(it->second);
+
+        self->streams.erase(it);
+        self->closeStream(*stream);
+
+        return 0;
+    }
+
+    ssize_t Http2Connection::readData(
+            nghttp2_session*,
+            int32_t,
+            uint8_t*,
+            size_t length,
+            uint32_t* dataFlags,
+            nghttp2_data_source* source,
+            void*
+    ) {
+        auto stream = static_cast<Http2Stream*>(source->ptr);
+
+        if (stream->pending.empty()) {
+            if (stream->ended) {
+                *dataFlags |= NGHTTP2_DATA_FLAG_EOF;
+                return 0;
+            }
+
+            stream->deferred = true;
+            return NGHTTP2_ERR_DEFERRED;
+        }
+
+        // Frames are cut from memory only, reading files in sendData would block the loop
+        if (stream->pending.front().file) {
+            if (!stream->reading && !stream->readAhead()) {
+                return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE;
+            }
+
+            stream->deferred = true;
+            return NGHTTP2_ERR_DEFERRED;
+        }
+
+        auto remaining = getRemainingLength(stream->pending.front());
+        auto frameLength = static_cast<size_t>(std::min<uint64_t>(length, remaining));
+
+        // The payload is written by sendData straight from the queued segment
+        *dataFlags |= NGHTTP2_DATA_FLAG_NO_COPY;
+
+        if (stream->ended && stream->pending.size() == 1 && frameLength == remaining) {
+            *dataFlags |= NGHTTP2_DATA_FLAG_EOF;
+        }
+
+        return static_cast<ssize_t>(frameLength);
+    }
+
+    int Http2Connection::sendData(
+            nghttp2_session*,
+            nghttp2_frame*,
+            const uint8_t* frameHeader,
+            size_t length,
+            nghttp2_data_source* source,
+            void* userData
+    ) {
+        auto self = static_cast<Http2Connection*>(userData);
+        auto stream = static_cast<Http2Stream*>(source->ptr);
+        auto& output = self->connection.output;
+        // File segments were read ahead into memory by readData
+        auto& segment = stream->pending.front();
+        OutputChunk payload{segment.data.data, length, segment.data.owner};
+
+        segment.data.data += length;
+        segment.data.length -= length;
+
+        output.append(std::string(reinterpret_cast<const char*>(frameHeader), frameHeaderLength));
+        output.append(std::move(payload));
+
+        if (!getRemainingLength(segment)) {
+            stream->pending.pop_front();
+        }
+
+        return 0;
+    }
+
+}
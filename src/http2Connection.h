@@ -0,0 +1,205 @@
+#pragma once
+
+#include <nghttp2/nghttp2.h>
+
+#include "commonHeaders.h"
+#include "fileSender.h"
+#include "outputBatch.h"
+#include "timerWheel.h"
+
+namespace nex {
+
+class HttpConnection;
+class Http2Connection;
+class Request;
+class Response;
+
+enum class PrefaceMatch {
+    None,
+    Partial,
+    Complete
+};
+
+/**
+ * One exchange of an HTTP/2 connection. The response queues its body here and DATA frames are
+ * cut from the queue as flow control allows, memory is framed without a copy. File ranges are
+ * read ahead into memory on the threadpool first.
+ */
+class Http2Stream : public std::enable_shared_from_this<Http2Stream> {
+public:
+    Http2Stream(Http2Connection* session, int32_t id) noexcept;
+    Http2Stream(const Http2Stream&) = delete;
+    Http2Stream& operator=(const Http2Stream&) = delete;
+
+    /**
+     * Takes the status and headers of the response, they are submitted with its first flush
+     */
+    void setHeaders(uint32_t statusCode, const HeaderMapping& headers, std::string_view date);
+
+    void write(OutputChunk data);
+    void write(FileSegment segment);
+    void flush();
+    void end();
+
+private:
+    friend class Http2Connection;
+
+    struct HeaderSpan {
+        size_t nameOffset;
+        size_t nameLength;
+        size_t valueOffset;
+        size_t valueLength;
+    };
+
+    static constexpr size_t readAheadLength = 64 * 1024;
+
+    static void handleRequestTimeout(TimerEntry& timer);
+    static void handleResponseTimeout(TimerEntry& timer);
+    static void handleRead(uv_fs_t* req);
+
+    /**
+     * Starts reading the next block of the file segment at the front of the queue
+     */
+    [[nodiscard]] bool readAhead();
+
+    Http2Connection* session;
+    int32_t id;
+
+    std::shared_ptr<Request> request{nullptr};
+    std::shared_ptr<Response> response{nullptr};
+
+    // Regular request headers as "name: value\r\n" lines, the request keeps them like an HTTP/1 block
+    std::string headerBlock;
+    std::vector<HeaderSpan> headerSpans;
+    std::string method;
+    std::string path;
+    std::string authority;
+    std::string cookies;
+    uint32_t requestError = 0;
+
+    std::vector<std::pair<std::string, std::string>> responseHeaders;
+    std::deque<FileSegment> pending;
+    // Runs while the request's headers or body are still coming, reset by every frame of them
+    TimerEntry requestTimer{handleRequestTimeout, this};
+    TimerEntry responseTimer{handleResponseTimeout, this};
+
+    uv_fs_t readRequest{};
+    std::string readBuffer;
+    // The stream and the file outlive a read that is still running when the stream closes
+    std::shared_ptr<Http2Stream> pendingRef{nullptr};
+    std::shared_ptr<const FileDescriptor> readFile{nullptr};
+
+    bool headersReady = false;
+    bool submitted = false;
+    bool ended = false;
+    // The data provider ran out of queued body and waits to be resumed
+    bool deferred = false;
+    bool reading = false;
+    // The body went over the limit, the rest of it is ignored
+    bool discardBody = false;
+    // Answered with 408 already, the next timeout resets the stream
+    bool requestTimedOut = false;
+};
+
+/**
+ * Server side of an HTTP/2 connection on top of nghttp2. The HttpConnection keeps the socket,
+ * its output and timers, this layer turns frames into requests and responses into frames.
+ */
+class Http2Connection {
+public:
+    explicit Http2Connection(HttpConnection& connection);
+    Http2Connection(const Http2Connection&) = delete;
+    Http2Connection& operator=(const Http2Connection&) = delete;
+    ~Http2Connection();
+
+    /**
+     * Whether received bytes open with the client connection preface
+     */
+    [[nodiscard]] static PrefaceMatch matchPreface(std::string_view data) noexcept;
+
+    /**
+     * Feeds received bytes to the session, false when the connection has to be closed
+     */
+    [[nodiscard]] bool receive(std::string_view data);
+
+    /**
+     * Sends GOAWAY and detaches every open stream, ahead of closing the connection
+     */
+    void terminate();
+
+    [[nodiscard]] bool hasActiveStreams() const noexcept { return !streams.empty(); }
+
+private:
+    friend class Http2Stream;
+
+    static constexpr size_t maxHeaderBlockLength = 16 * 1024;
+    static constexpr size_t frameHeaderLength = 9;
+
+    static int handleBeginHeaders(nghttp2_session*, const nghttp2_frame* frame, void* userData);
+    static int handleHeader(
+            nghttp2_session*,
+            const nghttp2_frame* frame,
+            const uint8_t* name,
+            size_t nameLength,
+            const uint8_t* value,
+            size_t valueLength,
+            uint8_t flags,
+            void* userData
+    );
+    static int handleFrame(nghttp2_session*, const nghttp2_frame* frame, void* userData);
+    static int handleDataChunk(
+            nghttp2_session*,
+            uint8_t flags,
+            int32_t streamId,
+            const uint8_t* data,
+            size_t length,
+            void* userData
+    );
+    static int handleStreamClose(nghttp2_session*, int32_t streamId, uint32_t errorCode, void* userData);
+    static ssize_t readData(
+            nghttp2_session*,
+            int32_t streamId,
+            uint8_t* buffer,
+            size_t length,
+            uint32_t* dataFlags,
+            nghttp2_data_source* source,
+            void* userData
+    );
+    static int sendData(
+            nghttp2_session*,
+            nghttp2_frame* frame,
+            const uint8_t* frameHeader,
+            size_t length,
+            nghttp2_data_source* source,
+            void* userData
+    );
+
+    [[nodiscard]] std::shared_ptr<Http2Stream> findStream(int32_t streamId) const;
+    [[nodiscard]] uv_loop_t* getLoop() const noexcept;
+
+    void startRequest(const std::shared_ptr<Http2Stream>& stream, bool endStream);
+    void receiveBody(Http2Stream& stream, std::string_view data);
+    void endRequestBody(Http2Stream& stream);
+    void closeStream(Http2Stream& stream);
+
+    void startRequestTimer(Http2Stream& stream);
+    void stopRequestTimer(Http2Stream& stream) noexcept;
+    void timeOutRequest(Http2Stream& stream);
+
+    /**
+     * Submits what the stream has ready and sends it
+     */
+    void commit(Http2Stream& stream);
+    void send();
+    [[nodiscard]] bool writeFrames();
+
+    HttpConnection& connection;
+    nghttp2_session* session = nullptr;
+    std::unordered_map<int32_t, std::shared_ptr<Http2Stream>> streams;
+
+    // nghttp2 can't send from inside its receive callbacks, frames go out once receiving is done
+    bool receiving = false;
+    bool terminated = false;
+};
+
+}
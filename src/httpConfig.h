@@ -9,7 +9,22 @@ namespace nex {
         uint32_t maxRequestBodyLength = 1024 * 1024 * 10;
         uint32_t maxRequestsPerConnection = 1000;
         uint32_t maxPathLength = 8 * 1024;
+        uint32_t readBufferBlockSize = 16 * 1024;
+        uint32_t readBufferPoolLimit = 1024;
+        uint32_t readBufferScratchSize = 64 * 1024;
+        bool sharedReadBuffer = true;
+        uint32_t maxCoalescedWriteSize = 64 * 1024;
+        bool coalesceWrites = true;
+        uint32_t ioThreads = 0;
+        // Route match results kept per event loop, 0 disables the cache
+        uint32_t routeCacheSize = 1024;
+        // Descriptors of large static files kept open per event loop, well under the usual 1024 of `ulimit -n`
+        uint32_t staticMaxOpenFiles = 256;
         bool persistentConnections = true;
+        // Serves HTTP/2 to clients that open with its connection preface (h2c with prior knowledge).
+        // Opt-in while the stack is young, connections accepted on I/O threads move to the main loop.
+        bool http2 = false;
+        uint32_t http2MaxConcurrentStreams = 100;
         std::string protocol = "http";
     };
 }
@@ -0,0 +1,162 @@
+#include "ioWorker.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "httpConnection.h"
+
+namespace nex {
+
+    IoWorker::IoWorker(
+        std::shared_ptr<AbstractRequestProcessor> requestProc,
+        v8::Isolate* isolate,
+        std::shared_ptr<HttpServerConfig> configuration,
+        std::shared_ptr<ConnectionHandOff> handOffTarget
+    ):
+        loop(uvw::Loop::create()),
+        loopContext(std::make_shared<LoopContext>(loop, configuration)),
+        config(std::move(configuration)),
+        handOff(std::move(handOffTarget)),
+        requestProcessor(std::move(requestProc)),
+        isolate(isolate)
+    {
+        loopContext->setHandOff(handOff);
+        routeCacheStats = loopContext->getRouteCache().getStats();
+
+        stopSignal = loop->resource<uvw::AsyncHandle>();
+        stopSignal->data(thisRef);
+        stopSignal->on<uvw::AsyncEvent>(handleStop);
+    }
+
+    IoWorker::~IoWorker() {
+        if (thread.joinable()) {
+            thread.join();
+            return;
+        }
+
+        // The loop never ran on its own thread, so its handles are closed here
+        closeHandles();
+        loopContext.reset();
+        loop->run();
+    }
+
+    void IoWorker::bind(const std::string& ip, uint32_t port) {
+        auto socket = createListeningSocket(ip, port);
+
+        tcpHandle = loop->resource<uvw::TCPHandle>();
+        tcpHandle->data(thisRef);
+
+        tcpHandle->on<uvw::ListenEvent>(handleConnection);
+        tcpHandle->on<uvw::ErrorEvent>(handleServerError);
+
+        auto err = uv_tcp_open(tcpHandle->raw(), socket);
+
+        if (err) {
+            ::close(socket);
+            throw std::runtime_error(std::string("Couldn't open listening socket: ") + uv_strerror(err));
+        }
+
+        tcpHandle->listen();
+    }
+
+    void IoWorker::start() {
+        thread = std::thread(&IoWorker::run, this);
+    }
+
+    void IoWorker::stop() noexcept {
+        if (stopRequested.exchange(true)) {
+            return;
+        }
+
+        stopSignal->send();
+    }
+
+    void IoWorker::run() {
+        loop->run();
+
+        // Loop-wide handles are inactive by now, closing them lets the loop finish
+        loopContext.reset();
+        loop->run();
+
+        handOff->postStopped(this);
+    }
+
+    void IoWorker::closeHandles() noexcept {
+        if (tcpHandle && !tcpHandle->closing()) {
+            tcpHandle->close();
+        }
+
+        if (stopSignal && !stopSignal->closing()) {
+            stopSignal->close();
+        }
+    }
+
+    uv_os_sock_t IoWorker::createListeningSocket(const std::string& ip, uint32_t port) {
+        sockaddr_storage address{};
+        socklen_t addressLength = sizeof(sockaddr_in);
+        int enable = 1;
+
+        if (uv_ip4_addr(ip.c_str(), static_cast<int>(port), reinterpret_cast<sockaddr_in*>(&address))) {
+            if (uv_ip6_addr(ip.c_str(), static_cast<int>(port), reinterpret_cast<sockaddr_in6*>(&address))) {
+                throw std::runtime_error("Invalid IP address: " + ip);
+            }
+
+            addressLength = sizeof(sockaddr_in6);
+        }
+
+        auto socket = ::socket(address.ss_family, SOCK_STREAM, 0);
+
+        if (socket < 0) {
+            throw std::runtime_error(std::string("Couldn't create listening socket: ") + std::strerror(errno));
+        }
+
+#ifdef SO_REUSEPORT
+        if (
+            setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable))
+            || setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable))
+            || ::bind(socket, reinterpret_cast<sockaddr*>(&address), addressLength)
+            || ::listen(socket, SOMAXCONN)
+        ) {
+            auto error = std::string("Couldn't listen on ") + ip + ":" + std::to_string(port) + ": "
+                + std::strerror(errno);
+
+            ::close(socket);
+            throw std::runtime_error(error);
+        }
+#else
+        ::close(socket);
+        throw std::runtime_error("I/O threads require SO_REUSEPORT support");
+#endif
+
+        return socket;
+    }
+
+    void IoWorker::handleConnection(const uvw::ListenEvent&, uvw::TCPHandle& server) {
+        auto client = server.loop().resource<uvw::TCPHandle>();
+        auto worker = server.data<IoWorker>();
+
+        auto httpConnection = new HttpConnection(
+            worker->loopContext,
+            worker->isolate,
+            client,
+            worker->requestProcessor,
+            worker->config
+        );
+
+        server.accept(*client);
+        httpConnection->startReading();
+    }
+
+    void IoWorker::handleServerError(const uvw::ErrorEvent&, uvw::TCPHandle& server) {
+        // Other workers keep serving the port
+        if (!server.closing()) {
+            server.close();
+        }
+    }
+
+    void IoWorker::handleStop(const uvw::AsyncEvent&, uvw::AsyncHandle& handle) {
+        handle.data<IoWorker>()->closeHandles();
+    }
+
+}
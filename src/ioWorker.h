@@ -0,0 +1,76 @@
+#pragma once
+
+#include <uvw.hpp>
+#include <v8.h>
+
+#include "commonHeaders.h"
+#include "httpConfig.h"
+#include "loopContext.h"
+#include "abstractRequestProcessor.h"
+#include "connectionHandOff.h"
+
+namespace nex {
+
+/**
+ * I/O thread with its own loop and SO_REUSEPORT listening socket.
+ *
+ * Connections accepted here are parsed and answered on this thread for as long as their
+ * routes are native only. A request that needs JS moves its connection to the main loop.
+ * The config is a snapshot taken at listen(), settings changed later don't reach the worker.
+ */
+class IoWorker {
+public:
+    IoWorker(
+        std::shared_ptr<AbstractRequestProcessor> requestProc,
+        v8::Isolate* isolate,
+        std::shared_ptr<HttpServerConfig> config,
+        std::shared_ptr<ConnectionHandOff> handOff
+    );
+    IoWorker(const IoWorker&) = delete;
+    IoWorker& operator=(const IoWorker&) = delete;
+    ~IoWorker();
+
+    /**
+     * Binds the listening socket on the calling thread, so that errors surface to the caller
+     */
+    void bind(const std::string& ip, uint32_t port);
+
+    void start();
+
+    [[nodiscard]] const std::shared_ptr<RouteCacheStats>& getRouteCacheStats() const noexcept {
+        return routeCacheStats;
+    }
+
+    /**
+     * Thread-safe. Stops accepting, the thread finishes once its connections are done
+     */
+    void stop() noexcept;
+
+private:
+    static uv_os_sock_t createListeningSocket(const std::string& ip, uint32_t port);
+
+    static void handleConnection(const uvw::ListenEvent&, uvw::TCPHandle& server);
+    static void handleServerError(const uvw::ErrorEvent&, uvw::TCPHandle& server);
+    static void handleStop(const uvw::AsyncEvent&, uvw::AsyncHandle& handle);
+
+    void run();
+    void closeHandles() noexcept;
+
+    std::shared_ptr<uvw::Loop> loop;
+    std::shared_ptr<LoopContext> loopContext;
+    std::shared_ptr<uvw::TCPHandle> tcpHandle{nullptr};
+    std::shared_ptr<uvw::AsyncHandle> stopSignal{nullptr};
+    std::shared_ptr<IoWorker> thisRef{this, noop<IoWorker>};
+    std::shared_ptr<HttpServerConfig> config;
+    std::shared_ptr<ConnectionHandOff> handOff;
+    // Outlives the loop context, which is released on the worker thread
+    std::shared_ptr<RouteCacheStats> routeCacheStats;
+
+    std::shared_ptr<AbstractRequestProcessor> requestProcessor;
+    v8::Isolate* isolate;
+
+    std::thread thread;
+    std::atomic<bool> stopRequested{false};
+};
+
+}
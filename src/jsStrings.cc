@@ -0,0 +1,134 @@
+#include "jsStrings.h"
+
+namespace nex {
+
+    namespace {
+        constexpr const char* keyNames[] = {
+            "cookies",
+            "customData",
+            "domain",
+            "expires",
+            "finished",
+            "handler",
+            "headers",
+            "headersSent",
+            "hostname",
+            "httpOnly",
+            "__instance",
+            "isErrorHandling",
+            "__isNexpressApp",
+            "__isNexpressNativeMiddleware",
+            "__isNexpressRouter",
+            "maxAge",
+            "method",
+            "originalUrl",
+            "params",
+            "path",
+            "query",
+            "runChain",
+            "sameSite",
+            "secure",
+        };
+
+        static_assert(std::size(keyNames) == static_cast<size_t>(JsKey::Count));
+
+        /**
+         * Bytes of a header block, released together with the last string that points into it
+         */
+        class SharedOneByteResource final : public v8::String::ExternalOneByteStringResource {
+        public:
+            SharedOneByteResource(std::shared_ptr<const std::string> owner, std::string_view value)
+                : owner(std::move(owner)), view(value) {}
+
+            [[nodiscard]] const char* data() const override { return view.data(); }
+            [[nodiscard]] size_t length() const override { return view.length(); }
+
+        private:
+            std::shared_ptr<const std::string> owner;
+            std::string_view view;
+        };
+
+        v8::Local<v8::String> internalize(v8::Isolate* isolate, std::string_view name) {
+            return v8::String::NewFromUtf8(
+                    isolate, name.data(), v8::NewStringType::kInternalized, static_cast<int>(name.length()))
+                            .ToLocalChecked();
+        }
+
+        bool isAscii(std::string_view value) noexcept {
+            for (auto c : value) {
+                if (static_cast<unsigned char>(c) > 0x7f) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    }
+
+    std::array<v8::Eternal<v8::String>, static_cast<size_t>(JsKey::Count)> JsStrings::keys;
+    std::array<v8::Eternal<v8::String>, HTTP_METHODS_COUNT> JsStrings::methods;
+    std::array<v8::Eternal<v8::String>, RequestHeaders::knownHeaderCount> JsStrings::headers;
+
+    void JsStrings::Init(v8::Isolate* isolate) {
+        v8::HandleScope handleScope(isolate);
+
+        for (size_t i = 0; i < keys.size(); ++i) {
+            keys[i].Set(isolate, internalize(isolate, keyNames[i]));
+        }
+
+        for (size_t i = 0; i < methods.size(); ++i) {
+            methods[i].Set(isolate, internalize(isolate, methodToString(ALL_HTTP_METHODS[i])));
+        }
+
+        for (size_t i = 0; i < headers.size(); ++i) {
+            headers[i].Set(isolate, internalize(isolate, RequestHeaders::nameOf(static_cast<KnownHeader>(i))));
+        }
+    }
+
+    v8::Local<v8::String> JsStrings::get(v8::Isolate* isolate, JsKey key) {
+        return keys[static_cast<size_t>(key)].Get(isolate);
+    }
+
+    v8::Local<v8::String> JsStrings::method(v8::Isolate* isolate, HttpMethod method) {
+        auto index = getMethodIndex(method);
+
+        if (index == HTTP_METHODS_COUNT) {
+            return v8::String::Empty(isolate);
+        }
+
+        return methods[index].Get(isolate);
+    }
+
+    v8::Local<v8::String> JsStrings::header(v8::Isolate* isolate, KnownHeader header) {
+        return headers[static_cast<size_t>(header)].Get(isolate);
+    }
+
+    v8::Local<v8::String> JsStrings::value(
+            v8::Isolate* isolate,
+            std::string_view value,
+            const std::shared_ptr<const std::string>& owner
+    ) {
+        // Other bytes would be read as Latin-1 rather than UTF-8
+        if (!owner || value.length() < minExternalLength || !isAscii(value)) {
+            return JsStrings::value(isolate, value);
+        }
+
+        auto resource = new SharedOneByteResource(owner, value);
+        v8::Local<v8::String> result;
+
+        if (!v8::String::NewExternalOneByte(isolate, resource).ToLocal(&result)) {
+            delete resource;
+
+            return JsStrings::value(isolate, value);
+        }
+
+        return result;
+    }
+
+    v8::Local<v8::String> JsStrings::value(v8::Isolate* isolate, std::string_view value) {
+        return v8::String::NewFromUtf8(
+                isolate, value.data(), v8::NewStringType::kNormal, static_cast<int>(value.length()))
+                        .ToLocalChecked();
+    }
+
+}
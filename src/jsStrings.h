@@ -0,0 +1,78 @@
+#pragma once
+
+#include <v8.h>
+
+#include "commonHeaders.h"
+#include "requestHeaders.h"
+
+namespace nex {
+
+/**
+ * Property names read or written on hot paths
+ */
+enum class JsKey : uint8_t {
+    Cookies,
+    CustomData,
+    Domain,
+    Expires,
+    Finished,
+    Handler,
+    Headers,
+    HeadersSent,
+    Hostname,
+    HttpOnly,
+    Instance,
+    IsErrorHandling,
+    IsNexpressApp,
+    IsNexpressNativeMiddleware,
+    IsNexpressRouter,
+    MaxAge,
+    Method,
+    OriginalUrl,
+    Params,
+    Path,
+    Query,
+    RunChain,
+    SameSite,
+    Secure,
+    Count
+};
+
+/**
+ * Internalized strings for property names, HTTP methods and well-known header names,
+ * created once when the addon is loaded and kept for the lifetime of the isolate.
+ */
+class JsStrings {
+public:
+    static void Init(v8::Isolate* isolate);
+
+    [[nodiscard]] static v8::Local<v8::String> get(v8::Isolate* isolate, JsKey key);
+    [[nodiscard]] static v8::Local<v8::String> method(v8::Isolate* isolate, HttpMethod method);
+
+    /**
+     * Lowercase name of a well-known request header
+     */
+    [[nodiscard]] static v8::Local<v8::String> header(v8::Isolate* isolate, KnownHeader header);
+
+    /**
+     * Value that lives in memory shared with `owner`. Long ASCII values become external strings
+     * that keep `owner` alive instead of being copied onto the V8 heap.
+     */
+    [[nodiscard]] static v8::Local<v8::String> value(
+            v8::Isolate* isolate,
+            std::string_view value,
+            const std::shared_ptr<const std::string>& owner
+    );
+
+    [[nodiscard]] static v8::Local<v8::String> value(v8::Isolate* isolate, std::string_view value);
+
+private:
+    // Shorter values are cheaper to copy than to track as external strings
+    static constexpr size_t minExternalLength = 64;
+
+    static std::array<v8::Eternal<v8::String>, static_cast<size_t>(JsKey::Count)> keys;
+    static std::array<v8::Eternal<v8::String>, HTTP_METHODS_COUNT> methods;
+    static std::array<v8::Eternal<v8::String>, RequestHeaders::knownHeaderCount> headers;
+};
+
+}
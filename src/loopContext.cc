@@ -0,0 +1,27 @@
+#include "loopContext.h"
+
+namespace nex {
+
+    LoopContext::LoopContext(std::shared_ptr<uvw::Loop> eventLoop, const std::shared_ptr<HttpServerConfig>& config)
+        : loop(std::move(eventLoop)),
+          readBufferAllocator(std::make_unique<SlabReadBufferAllocator>(
+              config->readBufferBlockSize,
+              config->readBufferPoolLimit,
+              config->sharedReadBuffer ? config->readBufferScratchSize : 0
+          )),
+          writeScheduler(loop),
+          headerCache(config),
+          timerWheel(loop),
+          routeCache(config->routeCacheSize),
+          staticFileCache(loop, config->staticMaxOpenFiles)
+    {}
+
+    void LoopContext::setReadBufferAllocator(std::unique_ptr<ReadBufferAllocator> allocator) {
+        readBufferAllocator = std::move(allocator);
+    }
+
+    void LoopContext::setHandOff(std::shared_ptr<ConnectionHandOff> target) {
+        handOff = std::move(target);
+    }
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <uvw.hpp>
+
+#include "commonHeaders.h"
+#include "bodyEncoder.h"
+#include "httpConfig.h"
+#include "headerCache.h"
+#include "pipelinePool.h"
+#include "readBufferAllocator.h"
+#include "routeCache.h"
+#include "staticFileCache.h"
+#include "timerWheel.h"
+#include "writeScheduler.h"
+
+namespace nex {
+
+class ConnectionHandOff;
+
+/**
+ * Resources shared by all connections served by one event loop.
+ */
+class LoopContext {
+public:
+    LoopContext(std::shared_ptr<uvw::Loop> eventLoop, const std::shared_ptr<HttpServerConfig>& config);
+
+    [[nodiscard]] const std::shared_ptr<uvw::Loop>& getLoop() const noexcept { return loop; }
+    [[nodiscard]] ReadBufferAllocator& getReadBufferAllocator() noexcept { return *readBufferAllocator; }
+    [[nodiscard]] WriteScheduler& getWriteScheduler() noexcept { return writeScheduler; }
+    [[nodiscard]] HeaderCache& getHeaderCache() noexcept { return headerCache; }
+    [[nodiscard]] TimerWheel& getTimerWheel() noexcept { return timerWheel; }
+    [[nodiscard]] PipelinePool& getPipelinePool() noexcept { return pipelinePool; }
+    [[nodiscard]] RouteCache& getRouteCache() noexcept { return routeCache; }
+    [[nodiscard]] EncoderPool& getEncoderPool() noexcept { return encoderPool; }
+    [[nodiscard]] StaticFileCache& getStaticFileCache() noexcept { return staticFileCache; }
+
+    /**
+     * Set on I/O thread loops only: where connections that need the isolate are moved to
+     */
+    [[nodiscard]] const std::shared_ptr<ConnectionHandOff>& getHandOff() const noexcept { return handOff; }
+    void setHandOff(std::shared_ptr<ConnectionHandOff> target);
+
+    /**
+     * Replaces the read buffer allocator, must be called before the loop serves any connection
+     */
+    void setReadBufferAllocator(std::unique_ptr<ReadBufferAllocator> allocator);
+
+private:
+    std::shared_ptr<uvw::Loop> loop;
+    std::unique_ptr<ReadBufferAllocator> readBufferAllocator;
+    WriteScheduler writeScheduler;
+    HeaderCache headerCache;
+    TimerWheel timerWheel;
+    PipelinePool pipelinePool;
+    RouteCache routeCache;
+    EncoderPool encoderPool;
+    StaticFileCache staticFileCache;
+    std::shared_ptr<ConnectionHandOff> handOff{nullptr};
+};
+
+}
@@ -1,4 +1,5 @@
 #include "middleware.h"
+#include "jsStrings.h"
 
 namespace nex {
 
@@ -8,7 +9,21 @@ PlainMiddleware::PlainMiddleware(
     const v8::Local<v8::Function>& middleware,
     bool errorHandling,
     v8::Isolate* isolate
-): callback(v8::Persistent<v8::Function, v8::CopyablePersistentTraits<v8::Function>>(isolate, middleware)), isolate(isolate), errorHandling(errorHandling) {}
+): callback(v8::Persistent<v8::Function, v8::CopyablePersistentTraits<v8::Function>>(isolate, middleware)), isolate(isolate), errorHandling(errorHandling) {
+    auto context = isolate->GetCurrentContext();
+    auto handlerKey = JsStrings::get(isolate, JsKey::Handler);
+    auto runnerKey = JsStrings::get(isolate, JsKey::RunChain);
+
+    v8::Local<v8::Value> handlerValue, runnerValue;
+
+    if (
+        middleware->Get(context, handlerKey).ToLocal(&handlerValue) && handlerValue->IsFunction()
+        && middleware->Get(context, runnerKey).ToLocal(&runnerValue) && runnerValue->IsFunction()
+    ) {
+        handler = FunctionPersistent(isolate, handlerValue.As<v8::Function>());
+        chainRunner = FunctionPersistent(isolate, runnerValue.As<v8::Function>());
+    }
+}
 
 void PlainMiddleware::emit(
     std::shared_ptr<Request> req,
@@ -46,6 +61,46 @@ void PlainMiddleware::emit(
     callback.Get(isolate)->Call(context, v8::Null(isolate), 3, argv);
 }
 
+void PlainMiddleware::emitChain(
+    const std::vector<PlainMiddleware*>& chain,
+    const std::shared_ptr<Request>& req,
+    const std::shared_ptr<Response>& res,
+    NextObject& next
+) {
+    auto first = chain.front();
+    auto isolate = first->isolate;
+
+    v8::HandleScope handleScope(isolate);
+    auto context = isolate->GetCurrentContext();
+    auto handlers = v8::Array::New(isolate, static_cast<int>(chain.size()));
+
+    for (uint32_t i = 0; i < chain.size(); ++i) {
+        handlers->Set(context, i, chain[i]->handler.Get(isolate)).Check();
+    }
+
+    v8::Local<v8::Value> argv[] = {
+        handlers,
+        req->getJsObject().Get(isolate),
+        res->getJsObject().Get(isolate),
+        next.getJsObject().Get(isolate)
+    };
+
+    v8::TryCatch tryCatch(isolate);
+
+    if (!first->chainRunner.Get(isolate)->Call(context, v8::Null(isolate), 4, argv).IsEmpty()) {
+        return;
+    }
+
+    // The runner itself threw, the request would hang otherwise
+    if (tryCatch.HasTerminated() || !tryCatch.HasCaught()) {
+        return;
+    }
+
+    v8::String::Utf8Value message(isolate, tryCatch.Exception());
+
+    next.error(*message ? *message : "Middleware chain failed");
+}
+
 // NativeLoadedMiddleware
 
 NativeLoadedMiddleware::NativeLoadedMiddleware(
@@ -62,6 +117,10 @@ NativeLoadedMiddleware::NativeLoadedMiddleware(
 
     internalEmit = lib->sym<InternalEmit>("emit");
     internalIsErrorHandling = lib->sym<InternalIsErrorHandling>("isErrorHandling");
+
+    // Written for the isolate thread unless the library says otherwise
+    auto internalIsThreadSafe = lib->sym<InternalIsThreadSafe>("isThreadSafe");
+    threadSafe = internalIsThreadSafe && internalIsThreadSafe();
 }
 
     bool NativeLoadedMiddleware::isErrorHandling() {
@@ -114,24 +173,60 @@ NativeLoadedMiddleware::NativeLoadedMiddleware(
         v8::Local<v8::Value> argv[argc] = { args[0] };
         v8::Local<v8::Function> cons = v8::Local<v8::Function>::New(isolate, constructor);
         v8::Local<v8::Context> context = isolate->GetCurrentContext();
-        v8::Local<v8::Object> instance =
-                cons->NewInstance(context, argc, argv).ToLocalChecked();
+        v8::Local<v8::Object> instance;
 
-        // Flag
-        auto nativeMiddlewareFlagKey = v8::String::NewFromUtf8(
-                isolate, "__isNexpressNativeMiddleware", v8::NewStringType::kNormal).ToLocalChecked();
-        auto nativeMiddlewareFlagValue = v8::Boolean::New(isolate, true);
+        if (!cons->NewInstance(context, argc, argv).ToLocal(&instance)) {
+            return;
+        }
 
-        instance->Set(nativeMiddlewareFlagKey, nativeMiddlewareFlagValue);
+        SetNativeFlag(isolate, instance);
 
         args.GetReturnValue().Set(instance);
     }
 
+    v8::MaybeLocal<v8::Object> NativeLoadedMiddlewareWrapper::FromMiddleware(
+        v8::Isolate* isolate,
+        std::shared_ptr<AbstractMiddleware> middleware
+    ) {
+        v8::EscapableHandleScope handleScope(isolate);
+        auto context = isolate->GetCurrentContext();
+        // Only read by New within this call
+        auto holder = std::make_unique<std::shared_ptr<AbstractMiddleware>>(std::move(middleware));
+
+        v8::Local<v8::Value> argv[] = { v8::External::New(isolate, holder.get()) };
+        v8::Local<v8::Object> instance;
+
+        if (!constructor.Get(isolate)->NewInstance(context, 1, argv).ToLocal(&instance)) {
+            return v8::MaybeLocal<v8::Object>();
+        }
+
+        SetNativeFlag(isolate, instance);
+
+        return handleScope.Escape(instance);
+    }
+
+    void NativeLoadedMiddlewareWrapper::SetNativeFlag(v8::Isolate* isolate, v8::Local<v8::Object> instance) {
+        auto nativeMiddlewareFlagKey = JsStrings::get(isolate, JsKey::IsNexpressNativeMiddleware);
+        auto nativeMiddlewareFlagValue = v8::Boolean::New(isolate, true);
+
+        instance->Set(nativeMiddlewareFlagKey, nativeMiddlewareFlagValue);
+    }
+
     void NativeLoadedMiddlewareWrapper::New(const v8::FunctionCallbackInfo<v8::Value>& args) {
         v8::Isolate* isolate = args.GetIsolate();
         v8::Local<v8::Context> context = isolate->GetCurrentContext();
 
         if (args.IsConstructCall()) {
+            if (!args[0].IsEmpty() && args[0]->IsExternal()) {
+                auto wrapper = new NativeLoadedMiddlewareWrapper;
+                auto holder = static_cast<std::shared_ptr<AbstractMiddleware>*>(args[0].As<v8::External>()->Value());
+
+                wrapper->instance = *holder;
+                wrapper->Wrap(args.This());
+                args.GetReturnValue().Set(args.This());
+                return;
+            }
+
             if (args[0].IsEmpty() || !args[0]->IsString()) {
                 isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(
                         isolate, "No native middleware path", v8::NewStringType::kNormal).ToLocalChecked()));
@@ -19,6 +19,7 @@ class NextObject;
 class AbstractMiddleware {
 public:
     virtual bool isErrorHandling() = 0;
+    virtual bool requiresIsolate(HttpMethod, const std::string&) const { return true; }
     virtual void emit(
         std::shared_ptr<Request> req,
         std::shared_ptr<Response> res,
@@ -45,9 +46,26 @@ public:
         NextObject& next
     ) final;
 
+    /**
+     * Runs consecutive middlewares of one route with a single call into JS,
+     * `next()` between them is handled by the JS runner of the first one
+     */
+    static void emitChain(
+        const std::vector<PlainMiddleware*>& chain,
+        const std::shared_ptr<Request>& req,
+        const std::shared_ptr<Response>& res,
+        NextObject& next
+    );
+
+    [[nodiscard]] bool isChainable() const noexcept { return !errorHandling && !handler.IsEmpty(); }
+
 private:
+    typedef v8::Persistent<v8::Function, v8::CopyablePersistentTraits<v8::Function>> FunctionPersistent;
 
-    v8::Persistent<v8::Function, v8::CopyablePersistentTraits<v8::Function>> callback;
+    FunctionPersistent callback;
+    // The user function and the runner for chains, set by the JS middleware wrapper
+    FunctionPersistent handler;
+    FunctionPersistent chainRunner;
     v8::Isolate* isolate;
     bool errorHandling = false;
 };
@@ -61,6 +79,7 @@ typedef void(InternalEmit)(
 );
 
 typedef bool(InternalIsErrorHandling)();
+typedef bool(InternalIsThreadSafe)();
 
 class NativeLoadedMiddleware final: public AbstractMiddleware {
 public:
@@ -72,6 +91,11 @@ public:
 
     bool isErrorHandling() final;
 
+    /**
+     * Loaded middlewares run on I/O threads only if they export `isThreadSafe` returning true
+     */
+    bool requiresIsolate(HttpMethod, const std::string&) const final { return !threadSafe; }
+
     void emit(
         std::shared_ptr<Request> req,
         std::shared_ptr<Response> res,
@@ -81,6 +105,7 @@ public:
 private:
     InternalEmit* internalEmit = nullptr;
     InternalIsErrorHandling* internalIsErrorHandling = nullptr;
+    bool threadSafe = false;
 
     std::shared_ptr<uvw::SharedLib> lib;
 };
@@ -89,14 +114,24 @@ class NativeLoadedMiddlewareWrapper : public node::ObjectWrap {
 public:
     static void Init(v8::Isolate* isolate);
     static void NewInstance(const v8::FunctionCallbackInfo<v8::Value>& args);
-    std::shared_ptr<NativeLoadedMiddleware> getInstance() {
+
+    /**
+     * Wraps a middleware built into the addon, so that it can be passed to `use` like a loaded one
+     */
+    static v8::MaybeLocal<v8::Object> FromMiddleware(
+        v8::Isolate* isolate,
+        std::shared_ptr<AbstractMiddleware> middleware
+    );
+
+    std::shared_ptr<AbstractMiddleware> getInstance() {
         return instance;
     };
 private:
     static v8::Global<v8::Function> constructor;
     static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void SetNativeFlag(v8::Isolate* isolate, v8::Local<v8::Object> instance);
 
-    std::shared_ptr<NativeLoadedMiddleware> instance;
+    std::shared_ptr<AbstractMiddleware> instance;
 };
 
 }
@@ -2,6 +2,9 @@
 
 #include "router.h"
 #include "application.h"
+#include "compressionMiddleware.h"
+#include "staticMiddleware.h"
+#include "jsStrings.h"
 
 
 namespace nex {
@@ -9,6 +12,7 @@ namespace nex {
     void InitAll(v8::Local<v8::Object>& exports, v8::Local<v8::Object> module) {
         v8::Isolate* isolate = v8::Isolate::GetCurrent();
 
+        JsStrings::Init(isolate);
         Application::Init(isolate);
         RouterWrap::Init(isolate);
         ResponseWrap::Init(isolate);
@@ -33,6 +37,8 @@ namespace nex {
         NODE_SET_METHOD((v8::Local<v8::Object>)exportsFunction, "Router", RouterWrap::NewInstance);
         NODE_SET_METHOD((v8::Local<v8::Object>)exportsFunction,
                 "NativeMiddlewareWrap", NativeLoadedMiddlewareWrapper::NewInstance);
+        NODE_SET_METHOD((v8::Local<v8::Object>)exportsFunction, "compression", CompressionMiddleware::NewInstance);
+        NODE_SET_METHOD((v8::Local<v8::Object>)exportsFunction, "static", StaticMiddleware::NewInstance);
 
         exportsFunction->SetName(functionNameLiteral);
 
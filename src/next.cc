@@ -1,16 +1,21 @@
 #include "next.h"
+#include "router.h"
+#include "jsStrings.h"
 
 namespace nex {
 
     // NextObject
 
-    NextObject::NextObject(std::function<void()> next, std::function<void()> nextRoute,
-                           std::function<void(std::string)> error, v8::Isolate* isolate
-       ): nextFn(next), nextRouteFn(nextRoute), errorFn(error), isolate(isolate) {}
+    NextObject::NextObject(Pipeline* pipeline, v8::Isolate* isolate)
+        : nextFn([this]() { next(); }),
+          nextRouteFn([this]() { nextRoute(); }),
+          errorFn([this](const std::string& err) { error(err); }),
+          pipeline(pipeline),
+          isolate(isolate) {}
 
     void NextObject::next() {
         try {
-            nextFn();
+            pipeline->next();
         } catch (const std::exception& e) {
             auto err = std::string(e.what());
 
@@ -20,7 +25,7 @@ namespace nex {
 
     void NextObject::nextRoute() {
         try {
-            nextRouteFn();
+            pipeline->nextRoute();
         } catch (const std::exception& e) {
             auto err = std::string(e.what());
 
@@ -30,7 +35,7 @@ namespace nex {
 
     void NextObject::error(const std::string& err) {
         try {
-            errorFn(err);
+            pipeline->error(err);
         } catch (const std::exception& e) {
             auto errInError = std::string(e.what());
 
@@ -46,12 +51,17 @@ namespace nex {
         return jsObj->persistent();
     }
 
-    NextObject::~NextObject() {
+    void NextObject::invalidate() {
         if (jsObj) {
             jsObj->invalidate();
+            jsObj = nullptr;
         }
     }
 
+    NextObject::~NextObject() {
+        invalidate();
+    }
+
     void NextObject::operator()() {
         next();
     }
@@ -66,6 +76,14 @@ namespace nex {
         }
 
         isValid = false;
+
+        // Lets JS middleware chains stop without asking C++ whether the request is over
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope handleScope(isolate);
+        auto object = handle(isolate);
+        auto finishedKey = JsStrings::get(isolate, JsKey::Finished);
+
+        object->Set(object->CreationContext(), finishedKey, v8::True(isolate)).Check();
         Unref();
     }
 
@@ -11,16 +11,16 @@
 namespace nex {
 
 class NextWrap;
+class Pipeline;
 
 class NextObject {
 
 public:
     NextObject() = default;
-    NextObject(std::function<void()> next,
-               std::function<void()> nextRoute,
-               std::function<void(std::string)> error,
-               v8::Isolate* isolate
-    );
+    NextObject(Pipeline* pipeline, v8::Isolate* isolate);
+
+    NextObject(const NextObject&) = delete;
+    NextObject& operator=(const NextObject&) = delete;
 
     void next();
 
@@ -30,15 +30,27 @@ public:
 
     v8::Persistent<v8::Object>& getJsObject();
 
+    [[nodiscard]] Pipeline* getPipeline() const noexcept { return pipeline; }
+
+    /**
+     * Detaches the JS object, so that calls made through it after the request are ignored
+     */
+    void invalidate();
+
     void operator() ();
 
     ~NextObject();
 
+    // Adapters for native middlewares, built once per pipeline and kept across requests
     std::function<void()> nextFn;
     std::function<void()> nextRouteFn;
     std::function<void(std::string)> errorFn;
+
 private:
     friend class NextWrap;
+    friend class Pipeline;
+
+    Pipeline* pipeline = nullptr;
     v8::Isolate* isolate = nullptr;
 
     NextWrap* jsObj = nullptr;
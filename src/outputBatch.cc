@@ -0,0 +1,104 @@
+#include "outputBatch.h"
+
+namespace nex {
+
+    // OutputChunk
+
+    OutputChunk OutputChunk::borrow(const char* data, size_t length) noexcept {
+        return OutputChunk{data, length, nullptr};
+    }
+
+    OutputChunk OutputChunk::take(std::string data) {
+        auto owner = std::make_shared<std::string>(std::move(data));
+
+        return OutputChunk{owner->data(), owner->length(), owner};
+    }
+
+    OutputChunk OutputChunk::copy(std::string_view data) {
+        return take(std::string(data));
+    }
+
+    // OutputBatch
+
+    void OutputBatch::append(OutputChunk chunk) {
+        if (!chunk.length) {
+            return;
+        }
+
+        entries.push_back(Entry{chunk.data, chunk.length, -1});
+        bytes += chunk.length;
+
+        if (chunk.owner) {
+            owners.push_back(std::move(chunk.owner));
+        }
+    }
+
+    void OutputBatch::append(std::string data) {
+        if (data.empty()) {
+            return;
+        }
+
+        // Pointers into the string are resolved on submit, the storage may move until then
+        entries.push_back(Entry{nullptr, data.length(), static_cast<ssize_t>(strings.size())});
+        bytes += data.length();
+        strings.push_back(std::move(data));
+    }
+
+    void OutputBatch::submit(uv_stream_t* stream, std::function<void(int)> onWritten) {
+        if (entries.empty()) {
+            if (onWritten) {
+                onWritten(0);
+            }
+            return;
+        }
+
+        auto request = new WriteRequest;
+        request->req.data = request;
+        request->strings = std::move(strings);
+        request->owners = std::move(owners);
+        request->onWritten = std::move(onWritten);
+        request->bufs.reserve(entries.size());
+
+        for (const auto& entry : entries) {
+            auto data = entry.stringIndex < 0 ? entry.data : request->strings[entry.stringIndex].data();
+
+            request->bufs.push_back(uv_buf_init(const_cast<char*>(data), static_cast<unsigned int>(entry.length)));
+        }
+
+        clear();
+
+        auto err = uv_write(
+            &request->req,
+            stream,
+            request->bufs.data(),
+            static_cast<unsigned int>(request->bufs.size()),
+            handleWrite
+        );
+
+        if (err) {
+            if (request->onWritten) {
+                request->onWritten(err);
+            }
+            delete request;
+        }
+    }
+
+    void OutputBatch::clear() noexcept {
+        entries.clear();
+        strings.clear();
+        owners.clear();
+        bytes = 0;
+    }
+
+    void OutputBatch::handleWrite(uv_write_t* req, int status) {
+        auto request = static_cast<WriteRequest*>(req->data);
+
+        // libuv reports write errors only here, so the status goes to the submitter before the buffers are released
+        if (request->onWritten) {
+            request->onWritten(status);
+        }
+
+        delete request;
+    }
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <uv.h>
+
+#include "commonHeaders.h"
+
+namespace nex {
+
+/**
+ * Piece of output that is either borrowed (the memory outlives the write) or kept alive by `owner`
+ */
+struct OutputChunk {
+    const char* data = nullptr;
+    size_t length = 0;
+    std::shared_ptr<const void> owner{nullptr};
+
+    static OutputChunk borrow(const char* data, size_t length) noexcept;
+    static OutputChunk take(std::string data);
+    static OutputChunk copy(std::string_view data);
+};
+
+/**
+ * Collects output pieces and submits them to a stream as a single vectored uv_write
+ */
+class OutputBatch {
+public:
+    OutputBatch() = default;
+    OutputBatch(const OutputBatch&) = delete;
+    OutputBatch& operator=(const OutputBatch&) = delete;
+
+    /**
+     * Queues a chunk without copying it
+     */
+    void append(OutputChunk chunk);
+
+    /**
+     * Queues a string that is moved into the batch, intended for headers and chunk framing
+     */
+    void append(std::string data);
+
+    [[nodiscard]] bool empty() const noexcept { return entries.empty(); }
+    [[nodiscard]] size_t byteLength() const noexcept { return bytes; }
+    [[nodiscard]] size_t bufferCount() const noexcept { return entries.size(); }
+
+    /**
+     * Writes everything queued so far and leaves the batch empty, `onWritten` gets the status of the write
+     */
+    void submit(uv_stream_t* stream, std::function<void(int)> onWritten = nullptr);
+
+    void clear() noexcept;
+
+private:
+    struct Entry {
+        const char* data;
+        size_t length;
+        ssize_t stringIndex;
+    };
+
+    struct WriteRequest {
+        uv_write_t req;
+        std::vector<uv_buf_t> bufs;
+        std::vector<std::string> strings;
+        std::vector<std::shared_ptr<const void>> owners;
+        std::function<void(int)> onWritten;
+    };
+
+    static void handleWrite(uv_write_t* req, int status);
+
+    std::vector<Entry> entries;
+    std::vector<std::string> strings;
+    std::vector<std::shared_ptr<const void>> owners;
+    size_t bytes = 0;
+};
+
+}
@@ -2,32 +2,258 @@
 
 namespace nex {
 
-    PathRegExp::PathRegExp(std::string regex, std::vector<std::string> paramKeys, bool canHandlePartial)
-        : regexString(std::move(regex)),
-          parameterNames(std::move(paramKeys)),
-          canHandlePartial(canHandlePartial)
+    PathRegExp::PathRegExp(
+        std::string regex,
+        std::vector<std::string> paramKeys,
+        bool canHandlePartial,
+        std::string pattern
+    ) : regexString(std::move(regex)),
+        pattern(std::move(pattern)),
+        parameterNames(std::move(paramKeys)),
+        canHandlePartial(canHandlePartial)
     {
-        if (canHandlePartial) {
-            setPartialCheckRegex(regexString);
-        } else {
-            setWholeCheckRegex(regexString);
+        checkPattern = canHandlePartial
+            ? getPartialCheckPattern(regexString)
+            : getWholeCheckPattern(regexString);
+
+        extractPrefilter();
+    }
+
+    PathRegExp::PathRegExp(const PathRegExp& other)
+        : checkRegex(std::atomic_load(&other.checkRegex)),
+          checkPattern(other.checkPattern),
+          regexString(other.regexString),
+          pattern(other.pattern),
+          parameterNames(other.parameterNames),
+          literalPrefix(other.literalPrefix),
+          minimumSegments(other.minimumSegments),
+          canHandlePartial(other.canHandlePartial)
+    {}
+
+    PathRegExp& PathRegExp::operator=(const PathRegExp& other) {
+        if (this == &other) {
+            return *this;
+        }
+
+        std::atomic_store(&checkRegex, std::atomic_load(&other.checkRegex));
+        checkPattern = other.checkPattern;
+        regexString = other.regexString;
+        pattern = other.pattern;
+        parameterNames = other.parameterNames;
+        literalPrefix = other.literalPrefix;
+        minimumSegments = other.minimumSegments;
+        canHandlePartial = other.canHandlePartial;
+
+        return *this;
+    }
+
+    namespace {
+
+        struct RegexTable {
+            std::mutex mutex;
+            std::unordered_map<std::string, std::weak_ptr<const std::regex>> regexes;
+            RegexCompileStats stats;
+            // Table size at which slots of released regexes are dropped next
+            size_t sweepAt = 64;
+        };
+
+        RegexTable& getRegexTable() {
+            static RegexTable table;
+
+            return table;
+        }
+
+        void dropExpired(RegexTable& table) {
+            for (auto it = table.regexes.begin(); it != table.regexes.end();) {
+                if (it->second.expired()) {
+                    it = table.regexes.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            table.sweepAt = std::max<size_t>(64, table.regexes.size() * 2);
+        }
+
+    }
+
+    std::shared_ptr<const std::regex> PathRegExp::compile(const std::string& pattern) {
+        auto& table = getRegexTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        auto& slot = table.regexes[pattern];
+
+        if (auto regex = slot.lock()) {
+            ++table.stats.reused;
+            return regex;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto regex = std::make_shared<const std::regex>(
+            pattern,
+            std::regex::ECMAScript | std::regex::optimize | std::regex::icase
+        );
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        ++table.stats.compiled;
+        table.stats.compileTime += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        slot = regex;
+
+        // Patterns of dropped routes would pile up otherwise, doubling the threshold keeps it amortized
+        if (table.regexes.size() >= table.sweepAt) {
+            dropExpired(table);
+        }
+
+        return regex;
+    }
+
+    RegexCompileStats PathRegExp::getCompileStats() {
+        auto& table = getRegexTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        auto stats = table.stats;
+
+        dropExpired(table);
+
+        stats.live = table.regexes.size();
+
+        return stats;
+    }
+
+    const std::regex& PathRegExp::getCheckRegex() const {
+        auto regex = std::atomic_load(&checkRegex);
+
+        if (!regex) {
+            regex = compile(checkPattern);
+            std::atomic_store(&checkRegex, regex);
+        }
+
+        // Never reset once set, so the reference outlives the local
+        return *regex;
+    }
+
+    void PathRegExp::prepare() const {
+        (void) getCheckRegex();
+    }
+
+    std::string_view PathRegExp::getFirstSegment() const noexcept {
+        if (literalPrefix.length() < 2 || literalPrefix[0] != '/') {
+            return std::string_view();
+        }
+
+        auto end = literalPrefix.find('/', 1);
+
+        if (end == std::string::npos) {
+            return std::string_view();
+        }
+
+        return std::string_view(literalPrefix).substr(1, end - 1);
+    }
+
+    bool PathRegExp::mayMatch(std::string_view path, size_t slashCount) const noexcept {
+        if (slashCount < minimumSegments || path.length() < literalPrefix.length()) {
+            return false;
+        }
+
+        return !compareLowercase(literalPrefix, path.substr(0, literalPrefix.length()));
+    }
+
+    void PathRegExp::extractPrefilter() {
+        constexpr std::string_view specialCharacters = "()[]{}|.*+?^$";
+
+        size_t depth = 0;
+        bool inClass = false;
+        bool prefixOpen = true;
+
+        for (size_t i = 0; i < regexString.length(); ++i) {
+            auto c = regexString[i];
+
+            if (inClass) {
+                if (c == '\\') {
+                    ++i;
+                } else if (c == ']') {
+                    inClass = false;
+                }
+
+                continue;
+            }
+
+            bool isLiteral = false;
+            char literal = c;
+
+            if (c == '\\' && i + 1 < regexString.length()) {
+                literal = regexString[++i];
+                // \d, \w and the like are classes, not characters
+                isLiteral = !std::isalnum(static_cast<unsigned char>(literal));
+            } else {
+                isLiteral = specialCharacters.find(c) == std::string_view::npos;
+            }
+
+            if (!isLiteral) {
+                switch (c) {
+                    case '(':
+                        ++depth;
+                        break;
+                    case ')':
+                        depth = depth ? depth - 1 : 0;
+                        break;
+                    case '[':
+                        inClass = true;
+                        break;
+                    case '|':
+                        // Top-level alternatives share nothing we can rely on
+                        if (!depth) {
+                            literalPrefix.clear();
+                            minimumSegments = 0;
+                            return;
+                        }
+                        break;
+                    default:
+                        break;
+                }
+
+                prefixOpen = false;
+                continue;
+            }
+
+            if (depth) {
+                continue;
+            }
+
+            auto quantifier = i + 1 < regexString.length() ? regexString[i + 1] : '\0';
+            bool optional = quantifier == '?' || quantifier == '*' || quantifier == '{';
+
+            if (literal == '/' && !optional) {
+                ++minimumSegments;
+            }
+
+            if (prefixOpen) {
+                if (optional || quantifier == '+') {
+                    prefixOpen = false;
+                } else {
+                    literalPrefix += static_cast<char>(std::tolower(static_cast<unsigned char>(literal)));
+                }
+            }
         }
     }
 
     bool PathRegExp::match(const std::string& path, RouteParamMapping& mapping, std::string& basePath,
-           std::string& restPath)
+           std::string& restPath) const
     {
-        if (canHandlePartial) {
-            return matchPartial(path, mapping, basePath, restPath);
-        }
+        // A pattern that slipped past Router::freeze, or a path too complex for the matcher, is just no match
+        try {
+            if (canHandlePartial) {
+                return matchPartial(path, mapping, basePath, restPath);
+            }
 
-        return matchWhole(path, mapping, basePath);
+            return matchWhole(path, mapping, basePath);
+        } catch (const std::regex_error&) {
+            return false;
+        }
     }
 
-    bool PathRegExp::matchWhole(const std::string& path, RouteParamMapping& mapping, std::string& basePath) {
+    bool PathRegExp::matchWhole(const std::string& path, RouteParamMapping& mapping, std::string& basePath) const {
         std::smatch matchResult;
 
-        if (std::regex_match(path, matchResult, wholeCheckRegex)) {
+        if (std::regex_match(path, matchResult, getCheckRegex())) {
             mapping.clear();
 
             if (matchResult.size() > 1) {
@@ -45,11 +271,11 @@ namespace nex {
     }
 
     bool PathRegExp::matchPartial(const std::string& path, RouteParamMapping& mapping, std::string& basePath,
-          std::string& restPath)
+          std::string& restPath) const
     {
         std::smatch matchResult;
 
-        if (std::regex_match(path, matchResult, partialCheckRegex)) {
+        if (std::regex_match(path, matchResult, getCheckRegex())) {
             mapping.clear();
 
             if (matchResult.size() > 1) {
@@ -60,7 +286,12 @@ namespace nex {
                 mapping[parameterNames[p]] = matchResult[i].str();
             }
 
-            restPath = matchResult[matchResult.size() - 1].str();
+            // Everything after the mount, like the route tree gives it, not just the last repeated segment
+            restPath = path.substr(static_cast<size_t>(matchResult.length(1)));
+
+            if (restPath.empty() || restPath.front() != '/') {
+                restPath.insert(restPath.begin(), '/');
+            }
 
             return true;
         }
@@ -7,59 +7,114 @@
 
 namespace nex {
 
+    /**
+     * Counters of the shared regex table, compile time in nanoseconds
+     */
+    struct RegexCompileStats {
+        uint64_t compiled = 0;
+        uint64_t reused = 0;
+        uint64_t live = 0;
+        uint64_t compileTime = 0;
+    };
+
     class PathRegExp {
     public:
 
-        PathRegExp(std::string regex, std::vector<std::string> paramKeys, bool canHandlePartial);
+        PathRegExp(
+                std::string regex,
+                std::vector<std::string> paramKeys,
+                bool canHandlePartial,
+                std::string pattern = std::string()
+        );
+
+        PathRegExp(const PathRegExp& other);
+        PathRegExp& operator=(const PathRegExp& other);
+
+        [[nodiscard]] static RegexCompileStats getCompileStats();
+
+        /**
+         * Compiles the check regex ahead of the first match, throws std::regex_error for a bad pattern
+         */
+        void prepare() const;
 
         bool match(
                 const std::string& path,
                 RouteParamMapping& mapping,
                 std::string& basePath,
                 std::string& restPath
-        );
-
-        inline bool operator==(const PathRegExp& other) {
+        ) const;
+
+        /**
+         * The path-to-regexp pattern the regex was generated from, empty when unknown
+         */
+        [[nodiscard]] const std::string& getPattern() const noexcept { return pattern; }
+        [[nodiscard]] const std::string& getRegexString() const noexcept { return regexString; }
+        [[nodiscard]] const std::vector<std::string>& getParameterNames() const noexcept { return parameterNames; }
+        [[nodiscard]] bool isPartial() const noexcept { return canHandlePartial; }
+
+        /**
+         * Lowercased literal text every matching path starts with
+         */
+        [[nodiscard]] const std::string& getLiteralPrefix() const noexcept { return literalPrefix; }
+
+        /**
+         * First path segment of every matching path, empty when it is not a literal
+         */
+        [[nodiscard]] std::string_view getFirstSegment() const noexcept;
+
+        /**
+         * Cheap check that rejects paths the regex cannot match, `slashCount` is the number of '/' in the path
+         */
+        [[nodiscard]] bool mayMatch(std::string_view path, size_t slashCount) const noexcept;
+
+        inline bool operator==(const PathRegExp& other) const {
             return regexString == other.regexString;
         }
 
-        inline bool operator!=(const PathRegExp& other) {
+        inline bool operator!=(const PathRegExp& other) const {
             return !(*this == other);
         }
 
     private:
-        bool matchWhole(const std::string& path, RouteParamMapping& mapping, std::string& basePath);
+        void extractPrefilter();
+
+        bool matchWhole(const std::string& path, RouteParamMapping& mapping, std::string& basePath) const;
 
         bool matchPartial(
                 const std::string& path,
                 RouteParamMapping& mapping,
                 std::string& basePath,
                 std::string& restPath
-        );
+        ) const;
 
-        inline static std::regex getRegex(const std::string& pattern) {
-            return std::regex(pattern, std::regex::ECMAScript | std::regex::optimize | std::regex::icase);
-        }
+        /**
+         * Compiles the check regex on first use. Regexes are shared by all routes with the same
+         * check pattern, so a route added for every method holds a single automaton.
+         */
+        [[nodiscard]] const std::regex& getCheckRegex() const;
 
-        inline void setWholeCheckRegex(const std::string& strippedRegex) {
-            auto pattern = "^(" + strippedRegex + R"()(?:\/?)$)";
-            wholeCheckRegex = getRegex(pattern);
-        }
+        [[nodiscard]] static std::shared_ptr<const std::regex> compile(const std::string& pattern);
 
-        inline void setPartialCheckRegex(const std::string& strippedRegex) {
-            std::string pattern;
+        inline static std::string getWholeCheckPattern(const std::string& strippedRegex) {
+            return "^(" + strippedRegex + R"()(?:\/?)$)";
+        }
 
-            if (strippedRegex[strippedRegex.length() - 1] != '/')
-                pattern = "^(" + strippedRegex + R"()(\/[^/\?#]*)*$)";
-            else
-                pattern = "^(" + strippedRegex + R"()([^/\?#]*\/?)*$)";
+        inline static std::string getPartialCheckPattern(const std::string& strippedRegex) {
+            if (strippedRegex.empty() || strippedRegex.back() != '/')
+                return "^(" + strippedRegex + R"()(\/[^/\?#]*)*$)";
 
-            partialCheckRegex = getRegex(pattern);
+            return "^(" + strippedRegex + R"()([^/\?#]*\/?)*$)";
         }
 
-        std::regex wholeCheckRegex, partialCheckRegex;
+        // Loaded and stored atomically, as routes may be matched on several I/O threads
+        mutable std::shared_ptr<const std::regex> checkRegex{nullptr};
+        std::string checkPattern;
         std::string regexString;
+        std::string pattern;
         std::vector<std::string> parameterNames;
+        std::string literalPrefix;
+        // Slashes required outside of groups, a lower bound of the path's segment count
+        size_t minimumSegments = 0;
         bool canHandlePartial;
     };
 
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "commonHeaders.h"
+
+namespace v8 {
+class Isolate;
+}
+
+namespace nex {
+
+class Pipeline;
+
+/**
+ * Idle pipelines of one event loop, reused by the requests it serves.
+ */
+class PipelinePool {
+public:
+    PipelinePool() = default;
+    PipelinePool(const PipelinePool&) = delete;
+    PipelinePool& operator=(const PipelinePool&) = delete;
+    ~PipelinePool();
+
+    [[nodiscard]] Pipeline* acquire(v8::Isolate* isolate);
+    void release(Pipeline* pipeline) noexcept;
+
+private:
+    static constexpr size_t maxPooled = 1024;
+
+    std::vector<Pipeline*> pipelines;
+};
+
+}
@@ -0,0 +1,54 @@
+#include "readBufferAllocator.h"
+
+namespace nex {
+
+    SlabReadBufferAllocator::SlabReadBufferAllocator(size_t blockSize, size_t poolLimit, size_t scratchSize)
+        : slabBlockSize(blockSize),
+          poolLimit(poolLimit),
+          scratchSize(scratchSize)
+    {
+        freeBlocks.reserve(poolLimit);
+
+        if (scratchSize) {
+            scratchBuffer = std::make_unique<char[]>(scratchSize);
+        }
+    }
+
+    SlabReadBufferAllocator::~SlabReadBufferAllocator() {
+        for (auto block : freeBlocks) {
+            delete[] block;
+        }
+    }
+
+    char* SlabReadBufferAllocator::allocate(size_t minimumSize, size_t& blockSize) {
+        if (minimumSize > slabBlockSize) {
+            blockSize = minimumSize;
+            return new char[minimumSize];
+        }
+
+        blockSize = slabBlockSize;
+
+        if (freeBlocks.empty()) {
+            return new char[slabBlockSize];
+        }
+
+        auto block = freeBlocks.back();
+        freeBlocks.pop_back();
+
+        return block;
+    }
+
+    void SlabReadBufferAllocator::release(char* block, size_t blockSize) noexcept {
+        if (blockSize != slabBlockSize || freeBlocks.size() >= poolLimit) {
+            delete[] block;
+            return;
+        }
+
+        freeBlocks.push_back(block);
+    }
+
+    uv_buf_t SlabReadBufferAllocator::scratch() noexcept {
+        return uv_buf_init(scratchBuffer.get(), static_cast<unsigned int>(scratchSize));
+    }
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <uv.h>
+
+#include "commonHeaders.h"
+
+namespace nex {
+
+/**
+ * Source of read buffer memory for client connections of one event loop.
+ */
+class ReadBufferAllocator {
+public:
+    virtual ~ReadBufferAllocator() = default;
+
+    /**
+     * Loans a block of at least `minimumSize` bytes, the actual size is stored in `blockSize`
+     */
+    virtual char* allocate(size_t minimumSize, size_t& blockSize) = 0;
+
+    /**
+     * Returns a block received from `allocate`
+     */
+    virtual void release(char* block, size_t blockSize) noexcept = 0;
+
+    /**
+     * Shared buffer for reads into connections that have no pending data.
+     * Its contents are only valid until the read callback returns.
+     */
+    virtual uv_buf_t scratch() noexcept { return uv_buf_init(nullptr, 0); }
+};
+
+/**
+ * Pools fixed-size blocks and optionally serves reads of idle connections from one scratch buffer,
+ * so connections only hold memory while a request is incomplete.
+ */
+class SlabReadBufferAllocator final : public ReadBufferAllocator {
+public:
+    SlabReadBufferAllocator(size_t blockSize, size_t poolLimit, size_t scratchSize);
+    ~SlabReadBufferAllocator() final;
+
+    char* allocate(size_t minimumSize, size_t& blockSize) final;
+    void release(char* block, size_t blockSize) noexcept final;
+    uv_buf_t scratch() noexcept final;
+
+private:
+    std::vector<char*> freeBlocks;
+    std::unique_ptr<char[]> scratchBuffer{nullptr};
+
+    size_t slabBlockSize;
+    size_t poolLimit;
+    size_t scratchSize;
+};
+
+}
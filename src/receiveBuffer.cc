@@ -0,0 +1,141 @@
+#include "receiveBuffer.h"
+
+namespace nex {
+
+    ReceiveBuffer::ReceiveBuffer(ReadBufferAllocator& allocator)
+        : allocator(&allocator) {}
+
+    ReceiveBuffer::~ReceiveBuffer() {
+        releaseStorage();
+    }
+
+    uv_buf_t ReceiveBuffer::prepare() {
+        if (readingIntoScratch) {
+            retain();
+        }
+
+        if (empty()) {
+            releaseStorage();
+
+            auto scratchBuffer = allocator->scratch();
+
+            if (scratchBuffer.base) {
+                scratch = scratchBuffer.base;
+                readingIntoScratch = true;
+                start = end = 0;
+
+                return scratchBuffer;
+            }
+        }
+
+        auto wanted = minimumReadSize;
+
+        if (!storage) {
+            reallocate(wanted);
+        } else if (capacity - end < wanted) {
+            auto used = size();
+
+            if (start > 0 && capacity - used >= wanted) {
+                std::memmove(storage, storage + start, used);
+                start = 0;
+                end = used;
+            } else {
+                reallocate(std::max(capacity * 2, used + wanted));
+            }
+        }
+
+        return uv_buf_init(storage + end, static_cast<unsigned int>(capacity - end));
+    }
+
+    void ReceiveBuffer::commit(size_t length) noexcept {
+        end += length;
+    }
+
+    void ReceiveBuffer::consume(size_t length) noexcept {
+        start = std::min(start + length, end);
+
+        if (start == end) {
+            start = end = 0;
+        }
+    }
+
+    void ReceiveBuffer::retain() {
+        if (!readingIntoScratch) {
+            if (empty()) {
+                releaseStorage();
+            }
+
+            return;
+        }
+
+        auto pending = size();
+        auto pendingStart = start;
+
+        readingIntoScratch = false;
+        start = end = 0;
+
+        if (pending) {
+            reallocate(std::max(pending, minimumReadSize));
+            std::memcpy(storage, scratch + pendingStart, pending);
+            end = pending;
+        }
+
+        scratch = nullptr;
+    }
+
+    void ReceiveBuffer::clear() noexcept {
+        start = end = 0;
+    }
+
+    std::string ReceiveBuffer::detach() {
+        retain();
+
+        std::string pending(data(), size());
+
+        clear();
+        releaseStorage();
+
+        return pending;
+    }
+
+    void ReceiveBuffer::attach(ReadBufferAllocator& newAllocator, std::string_view pending) {
+        releaseStorage();
+        clear();
+
+        allocator = &newAllocator;
+
+        if (!pending.empty()) {
+            reallocate(std::max(pending.length(), minimumReadSize));
+            std::memcpy(storage, pending.data(), pending.length());
+            end = pending.length();
+        }
+    }
+
+    void ReceiveBuffer::reallocate(size_t minimumCapacity) {
+        size_t newCapacity = 0;
+        auto used = size();
+        auto newStorage = allocator->allocate(minimumCapacity, newCapacity);
+
+        if (used) {
+            std::memcpy(newStorage, storage + start, used);
+        }
+
+        releaseStorage();
+
+        storage = newStorage;
+        capacity = newCapacity;
+        start = 0;
+        end = used;
+    }
+
+    void ReceiveBuffer::releaseStorage() noexcept {
+        if (!storage) {
+            return;
+        }
+
+        allocator->release(storage, capacity);
+        storage = nullptr;
+        capacity = 0;
+    }
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <uv.h>
+
+#include "commonHeaders.h"
+#include "readBufferAllocator.h"
+
+namespace nex {
+
+/**
+ * Per-connection receive buffer.
+ *
+ * libuv reads straight into the free tail of the buffer, the parser works on
+ * offsets into the readable region and consumed bytes are dropped from the front.
+ * Memory is loaned from the loop's ReadBufferAllocator only while unparsed data is pending,
+ * reads into an idle connection land in the allocator's shared scratch buffer.
+ */
+class ReceiveBuffer {
+public:
+    static constexpr size_t minimumReadSize = 4 * 1024;
+
+    explicit ReceiveBuffer(ReadBufferAllocator& allocator);
+    ReceiveBuffer(const ReceiveBuffer&) = delete;
+    ReceiveBuffer& operator=(const ReceiveBuffer&) = delete;
+    ~ReceiveBuffer();
+
+    /**
+     * Returns free space for the next read, compacting or growing the loaned storage if needed
+     */
+    uv_buf_t prepare();
+
+    /**
+     * Marks `length` bytes of the prepared space as readable
+     */
+    void commit(size_t length) noexcept;
+
+    /**
+     * Drops `length` bytes from the front of the readable region
+     */
+    void consume(size_t length) noexcept;
+
+    /**
+     * Must be called once the read callback is done with the data:
+     * moves pending bytes out of the scratch buffer and returns storage that is no longer needed
+     */
+    void retain();
+
+    void clear() noexcept;
+
+    /**
+     * Hands unparsed bytes out and returns all storage, used when the connection leaves its loop
+     */
+    std::string detach();
+
+    /**
+     * Binds the buffer to another loop's allocator and restores bytes returned by detach()
+     */
+    void attach(ReadBufferAllocator& newAllocator, std::string_view pending);
+
+    [[nodiscard]] const char* data() const noexcept { return (readingIntoScratch ? scratch : storage) + start; }
+    [[nodiscard]] size_t size() const noexcept { return end - start; }
+    [[nodiscard]] bool empty() const noexcept { return start == end; }
+
+private:
+    void reallocate(size_t minimumCapacity);
+    void releaseStorage() noexcept;
+
+    ReadBufferAllocator* allocator;
+
+    char* storage = nullptr;
+    char* scratch = nullptr;
+    size_t capacity = 0;
+    size_t start = 0;
+    size_t end = 0;
+
+    bool readingIntoScratch = false;
+};
+
+}
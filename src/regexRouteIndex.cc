@@ -0,0 +1,92 @@
+#include "regexRouteIndex.h"
+
+namespace nex {
+
+    void RegexRouteIndex::insert(const PathRegExp& re, size_t index) {
+        auto segment = re.getFirstSegment();
+        ++count;
+
+        if (segment.empty()) {
+            unindexed.push_back(Candidate{index, &re});
+            return;
+        }
+
+        auto it = std::lower_bound(
+            bySegment.begin(),
+            bySegment.end(),
+            segment,
+            [](const auto& group, std::string_view key) { return group.first < key; }
+        );
+
+        if (it == bySegment.end() || it->first != segment) {
+            it = bySegment.emplace(it, std::string(segment), std::vector<Candidate>());
+        }
+
+        it->second.push_back(Candidate{index, &re});
+    }
+
+    void RegexRouteIndex::prepare() const {
+        for (const auto& candidate : unindexed) {
+            candidate.re->prepare();
+        }
+
+        for (const auto& [segment, candidates] : bySegment) {
+            for (const auto& candidate : candidates) {
+                candidate.re->prepare();
+            }
+        }
+    }
+
+    void RegexRouteIndex::match(std::string_view path, std::vector<RouteMatch>& matches) const {
+        if (!count) {
+            return;
+        }
+
+        auto slashCount = static_cast<size_t>(std::count(path.begin(), path.end(), '/'));
+
+        addCandidates(unindexed, path, slashCount, matches);
+
+        if (bySegment.empty() || path.empty() || path.front() != '/') {
+            return;
+        }
+
+        auto end = path.find('/', 1);
+        auto segment = path.substr(1, end == std::string_view::npos ? std::string_view::npos : end - 1);
+        size_t low = 0, high = bySegment.size();
+
+        while (low < high) {
+            auto middle = (low + high) / 2;
+            auto comparison = compareLowercase(bySegment[middle].first, segment);
+
+            if (!comparison) {
+                addCandidates(bySegment[middle].second, path, slashCount, matches);
+                return;
+            }
+
+            if (comparison < 0) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+    }
+
+    void RegexRouteIndex::addCandidates(
+        const std::vector<Candidate>& candidates,
+        std::string_view path,
+        size_t slashCount,
+        std::vector<RouteMatch>& matches
+    ) const {
+        for (const auto& [index, re] : candidates) {
+            if (re->mayMatch(path, slashCount)) {
+                // Named fields, a positional initializer goes out of step with the struct silently
+                RouteMatch match{};
+
+                match.index = index;
+                match.needsRegex = true;
+                matches.push_back(match);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "commonHeaders.h"
+#include "pathRegexp.h"
+#include "routeTree.h"
+
+namespace nex {
+
+/**
+ * Prefilter for routes that still need their regex.
+ *
+ * Routes are grouped by the literal first segment of their pattern, so that a path only
+ * looks at its own group and the routes without one. Candidates are then checked against
+ * their literal prefix and minimum segment count before any regex runs.
+ */
+class RegexRouteIndex {
+public:
+    /**
+     * Routes must be inserted in registration order and outlive the index
+     */
+    void insert(const PathRegExp& re, size_t index);
+
+    /**
+     * Appends the routes whose regex may match the path
+     */
+    void match(std::string_view path, std::vector<RouteMatch>& matches) const;
+
+    /**
+     * Compiles the regexes of every route, throws std::regex_error for a bad pattern
+     */
+    void prepare() const;
+
+    [[nodiscard]] bool empty() const noexcept { return !count; }
+
+private:
+    struct Candidate {
+        size_t index;
+        const PathRegExp* re;
+    };
+
+    void addCandidates(
+        const std::vector<Candidate>& candidates,
+        std::string_view path,
+        size_t slashCount,
+        std::vector<RouteMatch>& matches
+    ) const;
+
+    // Sorted by the lowercased first segment
+    std::vector<std::pair<std::string, std::vector<Candidate>>> bySegment;
+    std::vector<Candidate> unindexed;
+    size_t count = 0;
+};
+
+}
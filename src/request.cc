@@ -1,6 +1,38 @@
 #include "request.h"
 
 namespace nex {
+    namespace {
+        /**
+         * String or array of strings, empty for an absent value
+         */
+        v8::Local<v8::Value> toJsValue(v8::Isolate* isolate, const MaybeStringArrayValue& value) {
+            if (auto ref = std::get_if<std::string>(&value)) {
+                return JsStrings::value(isolate, *ref);
+            }
+
+            if (auto ref = std::get_if<std::vector<std::string>>(&value)) {
+                auto context = isolate->GetCurrentContext();
+                auto values = v8::Array::New(isolate, static_cast<int>(ref->size()));
+
+                for (uint32_t i = 0; i < ref->size(); ++i) {
+                    values->Set(context, i, JsStrings::value(isolate, (*ref)[i])).Check();
+                }
+
+                return values;
+            }
+
+            return v8::Local<v8::Value>();
+        }
+
+        std::string lowercaseName(std::string_view name) {
+            std::string lowercased(name);
+
+            stringToLower(lowercased);
+
+            return lowercased;
+        }
+    }
+
     Request::Request(
         std::shared_ptr<HttpConnection> httpConnection,
         v8::Isolate* isolate,
@@ -29,6 +61,21 @@ namespace nex {
         }
     }
 
+    void Request::onChunk(BodyChunkCallback cb) {
+        onChunkCallback = cb;
+
+        if (!bodyBuffer.empty()) {
+            BodyChunk chunk(std::move(bodyBuffer));
+
+            bodyBuffer.clear();
+            onChunkCallback(chunk);
+
+            if (isFullData && onDataEndCallback) {
+                onDataEndCallback();
+            }
+        }
+    }
+
     void Request::onDataEnd(DataEndCallback cb) {
         onDataEndCallback = cb;
 
@@ -37,7 +84,7 @@ namespace nex {
         }
     }
 
-    void Request::handleData(const std::string& data) {
+    void Request::handleData(std::string_view data) {
         if (!isAlive)
             return;
 
@@ -47,14 +94,18 @@ namespace nex {
             isFullData = true;
         }
 
-        if (onDataCallback) {
-            onDataCallback(data);
+        if (onChunkCallback || onDataCallback) {
+            if (onChunkCallback) {
+                onChunkCallback(BodyChunk(data));
+            } else {
+                onDataCallback(data);
+            }
 
             if (isFullData && onDataEndCallback) {
                 onDataEndCallback();
             }
         } else {
-            bodyBuffer += data;
+            bodyBuffer.append(data.data(), data.length());
         }
     }
 
@@ -66,10 +117,10 @@ namespace nex {
         }
 
         onDataCallback = nullptr;
+        onChunkCallback = nullptr;
         onDataEndCallback = nullptr;
 
-        if (jsObj)
-            jsObj->invalidate();
+        releaseJsObject();
     }
 
     void Request::handleDataEnd() {
@@ -81,6 +132,7 @@ namespace nex {
 
         onDataEndCallback = nullptr;
         onDataCallback = nullptr;
+        onChunkCallback = nullptr;
     }
 
     void Request::parseQueryString() {
@@ -120,12 +172,12 @@ namespace nex {
     }
 
     void Request::parseCookies() {
-        auto valuePtr = std::get_if<std::string>(&getHeader("Cookie"));
+        auto cookieHeader = headers.get(KnownHeader::Cookie);
 
-        if (!valuePtr || !valuePtr->length()) {
+        if (cookieHeader.empty()) {
             return;
         }
-        std::stringstream stream(*valuePtr);
+        std::stringstream stream{std::string(cookieHeader)};
         std::string nameBuf, valueBuf;
 
         while (stream) {
@@ -146,7 +198,34 @@ namespace nex {
     }
 
     const HeaderValue& Request::getHeader(const std::string& name) {
-        return headers[name];
+        auto it = headerValues.find(name);
+
+        if (it != headerValues.end()) {
+            return it->second;
+        }
+
+        auto& value = headerValues[name];
+        auto id = RequestHeaders::lookup(name);
+
+        for (const auto& entry : headers.entries()) {
+            if (id != KnownHeader::Unknown ? entry.id == id : equalsCaseInsensitive(entry.name, name)) {
+                appendHeaderValue(value, entry.value);
+            }
+        }
+
+        return value;
+    }
+
+    std::string_view Request::getHeaderView(KnownHeader header) const noexcept {
+        return headers.get(header);
+    }
+
+    std::string_view Request::getHeaderView(std::string_view name) const noexcept {
+        return headers.get(name);
+    }
+
+    const RequestHeaders& Request::getHeaders() const noexcept {
+        return headers;
     }
 
     std::string Request::getHost() {
@@ -154,13 +233,9 @@ namespace nex {
             return host;
         }
 
-        if (auto ref = std::get_if<std::string>(&getHeader("Host"))) {
-            host = *ref;
+        host = headers.get(KnownHeader::Host);
 
-            return host;
-        }
-
-        return std::string();
+        return host;
     }
 
     std::string Request::getUrl() {
@@ -189,12 +264,16 @@ namespace nex {
     }
 
     const QueryParameterValue& Request::getQueryParam(const std::string& name) {
+        return getQueryParams()[name];
+    }
+
+    QueryParamMapping& Request::getQueryParams() {
         if (!isQueryStringParsed) {
             isQueryStringParsed = true;
             parseQueryString();
         }
 
-        return queryParams[name];
+        return queryParams;
     }
 
     const RouteParameterValue& Request::getRouteParam(const std::string& name) {
@@ -202,12 +281,16 @@ namespace nex {
     }
 
     const CookieValue& Request::getCookie(const std::string& name) {
+        return getCookies()[name];
+    }
+
+    CookieMapping& Request::getCookies() {
         if (!areCookiesParsed) {
             areCookiesParsed = true;
             parseCookies();
         }
 
-        return cookies[name];
+        return cookies;
     }
 
     v8::Persistent<v8::Object>& Request::getJsObject() {
@@ -229,6 +312,10 @@ namespace nex {
     void Request::setCustomData(const std::string& key, const std::string& value) {
         customData[key] = value;
 
+        if (!isAlive) {
+            return;
+        }
+
         if (!jsObj) {
             createJsObject();
         }
@@ -237,30 +324,26 @@ namespace nex {
     }
 
     Request::~Request() {
-        if (jsObj) {
-            jsObj->invalidate();
-        }
+        releaseJsObject();
     }
 
     Request::Request(uint32_t errorStatusCode)
         : requestError(errorStatusCode) {}
 
-    void Request::appendHeader(const std::string& name, std::string value) {
-        auto& currentValue = headers[name];
-
+    void Request::appendHeaderValue(HeaderValue& currentValue, std::string_view value) {
         if (auto ref = std::get_if<std::vector<std::string>>(&currentValue)) {
-            ref->push_back(std::move(value));
+            ref->emplace_back(value);
             return;
         }
 
         if (auto ref = std::get_if<std::string>(&currentValue)) {
-            auto val = *ref;
+            auto val = std::move(*ref);
 
-            currentValue = std::vector<std::string>{val, value};
+            currentValue = std::vector<std::string>{std::move(val), std::string(value)};
             return;
         }
 
-        currentValue = std::move(value);
+        currentValue = std::string(value);
     }
 
     void Request::setRelativePath(const std::string& relPath) {
@@ -321,6 +404,15 @@ namespace nex {
         }
     }
 
+    void Request::releaseJsObject() {
+        if (!jsObj) {
+            return;
+        }
+
+        jsObj->invalidate();
+        jsObj = nullptr;
+    }
+
     // RequestWrap
 
     v8::Global<v8::Function> RequestWrap::constructor;
@@ -331,6 +423,9 @@ namespace nex {
         }
 
         isValid = false;
+        instance = nullptr;
+        onDataCallback.Reset();
+        onDataEndCallback.Reset();
         Unref();
     }
 
@@ -341,8 +436,7 @@ namespace nex {
 
         auto isolate = instance->isolate;
         auto inst = handle(isolate);
-        auto customDataObjectKey = v8::String::NewFromUtf8(
-                isolate, "customData", v8::NewStringType::kNormal).ToLocalChecked();
+        auto customDataObjectKey = JsStrings::get(isolate, JsKey::CustomData);
         auto customDataKey = v8::String::NewFromUtf8(
                 isolate, key.c_str(), v8::NewStringType::kNormal).ToLocalChecked();
         auto customDataValue = v8::String::NewFromUtf8(
@@ -367,114 +461,141 @@ namespace nex {
         auto isolate = instance->isolate;
         auto reqObjectHandle = handle(isolate);
 
-        /// Cookie
+        /// Method
 
-        auto cookieKey = v8::String::NewFromUtf8(
-                isolate, "cookies", v8::NewStringType::kNormal).ToLocalChecked();
-        auto cookieObj = v8::Object::New(isolate);
-        reqObjectHandle->Set(cookieKey, cookieObj);
+        auto methodKey = JsStrings::get(isolate, JsKey::Method);
+        auto methodValue = JsStrings::method(isolate, instance->method);
 
-        for (const auto& [key, value] : instance->cookies) {
-            if (auto ref = std::get_if<std::string>(&value)) {
-                auto k = v8::String::NewFromUtf8(
-                        isolate, key.c_str(), v8::NewStringType::kNormal).ToLocalChecked();
-                auto v = v8::String::NewFromUtf8(
-                        isolate, ref->c_str(), v8::NewStringType::kNormal).ToLocalChecked();
+        reqObjectHandle->Set(methodKey, methodValue);
 
-                cookieObj->Set(k, v);
-            }
-        }
+        /// originalUrl
 
-        /// Route Params
+        auto originalUrlKey = JsStrings::get(isolate, JsKey::OriginalUrl);
+        auto originalUrlValue = v8::String::NewFromUtf8(
+                isolate, instance->path.c_str(), v8::NewStringType::kNormal).ToLocalChecked();
 
-        auto routeParamsKey = v8::String::NewFromUtf8(
-                isolate, "params", v8::NewStringType::kNormal).ToLocalChecked();
-        auto routeParamsObj = v8::Object::New(isolate);
-        reqObjectHandle->Set(routeParamsKey, routeParamsObj);
+        reqObjectHandle->Set(originalUrlKey, originalUrlValue);
 
-        for (const auto& [key, value] : instance->routeParams) {
-            if (auto ref = std::get_if<std::string>(&value)) {
-                auto k = v8::String::NewFromUtf8(
-                        isolate, key.c_str(), v8::NewStringType::kNormal).ToLocalChecked();
-                auto v = v8::String::NewFromUtf8(
-                        isolate, ref->c_str(), v8::NewStringType::kNormal).ToLocalChecked();
+        /// Relative Path
 
-                routeParamsObj->Set(k, v);
-            }
-        }
+        auto relativePathKey = JsStrings::get(isolate, JsKey::Path);
+        auto relativePathValue = v8::String::NewFromUtf8(
+                isolate, instance->getRelativePath().c_str(), v8::NewStringType::kNormal).ToLocalChecked();
 
-        /// Query Params
+        reqObjectHandle->Set(relativePathKey, relativePathValue);
+    }
 
-        auto queryParamsKey = v8::String::NewFromUtf8(
-                isolate, "query", v8::NewStringType::kNormal).ToLocalChecked();
-        auto queryParamsObj = v8::Object::New(isolate);
-        reqObjectHandle->Set(queryParamsKey, queryParamsObj);
+    void RequestWrap::GetHeaders(v8::Local<v8::Name>, const v8::PropertyCallbackInfo<v8::Value>& info) {
+        auto isolate = info.GetIsolate();
+        auto wrapInstance = ObjectWrap::Unwrap<RequestWrap>(info.Holder());
+        auto headersObj = v8::Object::New(isolate);
 
-        for (const auto& [key, value] : instance->queryParams) {
-            auto k = v8::String::NewFromUtf8(
-                    isolate, key.c_str(), v8::NewStringType::kNormal).ToLocalChecked();
-            v8::Local<v8::Value> v;
+        info.GetReturnValue().Set(headersObj);
 
-            if (auto ref = std::get_if<std::string>(&value)) {
-                v = v8::String::NewFromUtf8(
-                        isolate, ref->c_str(), v8::NewStringType::kNormal).ToLocalChecked();
+        if (!wrapInstance->isValid) {
+            return;
+        }
+
+        auto context = isolate->GetCurrentContext();
+        const auto& headers = wrapInstance->instance->headers;
+
+        // Names are lowercased like Node does, repeated headers are collected into arrays
+        for (const auto& entry : headers.entries()) {
+            auto key = entry.id != KnownHeader::Unknown
+                    ? JsStrings::header(isolate, entry.id)
+                    : JsStrings::value(isolate, lowercaseName(entry.name));
+            auto value = JsStrings::value(isolate, entry.value, headers.getBlock());
+
+            if (!headersObj->HasOwnProperty(context, key).FromMaybe(false)) {
+                headersObj->CreateDataProperty(context, key, value).Check();
+                continue;
             }
 
-            if (auto ref = std::get_if<std::vector<std::string>>(&value)) {
-                auto values = v8::Array::New(isolate, ref->size());
+            auto current = headersObj->Get(context, key).ToLocalChecked();
 
-                if (!values.IsEmpty()) {
-                    for (size_t i = 0; i < ref->size(); ++i) {
-                        auto value = v8::String::NewFromUtf8(
-                                isolate, (*ref)[i].c_str(), v8::NewStringType::kNormal).ToLocalChecked();
-                        values->Set(i, value);
-                    }
+            if (current->IsArray()) {
+                auto values = current.As<v8::Array>();
 
-                    v = values;
-                }
+                values->Set(context, values->Length(), value).Check();
+                continue;
             }
 
-            if (!v.IsEmpty()) {
-                queryParamsObj->Set(k, v);
+            v8::Local<v8::Value> pair[] = {current, value};
+
+            headersObj->CreateDataProperty(context, key, v8::Array::New(isolate, pair, 2)).Check();
+        }
+    }
+
+    void RequestWrap::GetCookies(v8::Local<v8::Name>, const v8::PropertyCallbackInfo<v8::Value>& info) {
+        auto isolate = info.GetIsolate();
+        auto wrapInstance = ObjectWrap::Unwrap<RequestWrap>(info.Holder());
+        auto cookieObj = v8::Object::New(isolate);
+
+        info.GetReturnValue().Set(cookieObj);
+
+        if (!wrapInstance->isValid) {
+            return;
+        }
+
+        auto context = isolate->GetCurrentContext();
+
+        for (const auto& [key, value] : wrapInstance->instance->getCookies()) {
+            if (auto ref = std::get_if<std::string>(&value)) {
+                cookieObj->Set(context, JsStrings::value(isolate, key), JsStrings::value(isolate, *ref)).Check();
             }
         }
+    }
+
+    void RequestWrap::GetParams(v8::Local<v8::Name>, const v8::PropertyCallbackInfo<v8::Value>& info) {
+        auto isolate = info.GetIsolate();
+        auto wrapInstance = ObjectWrap::Unwrap<RequestWrap>(info.Holder());
+        auto routeParamsObj = v8::Object::New(isolate);
 
-        /// Hostname
+        info.GetReturnValue().Set(routeParamsObj);
 
-        auto hostNameKey = v8::String::NewFromUtf8(
-                isolate, "hostname", v8::NewStringType::kNormal).ToLocalChecked();
-        auto hostNameValue = v8::String::NewFromUtf8(
-                isolate, instance->getHost().c_str(), v8::NewStringType::kNormal).ToLocalChecked();
+        if (!wrapInstance->isValid) {
+            return;
+        }
 
-        reqObjectHandle->Set(hostNameKey, hostNameValue);
+        auto context = isolate->GetCurrentContext();
 
-        /// Method
+        for (const auto& [key, value] : wrapInstance->instance->routeParams) {
+            if (auto ref = std::get_if<std::string>(&value)) {
+                routeParamsObj->Set(context, JsStrings::value(isolate, key), JsStrings::value(isolate, *ref)).Check();
+            }
+        }
+    }
 
-        auto methodKey = v8::String::NewFromUtf8(
-                isolate, "method", v8::NewStringType::kNormal).ToLocalChecked();
-        auto methodValue = v8::String::NewFromUtf8(
-                isolate, methodToString(instance->method).c_str(), v8::NewStringType::kNormal)
-                        .ToLocalChecked();
+    void RequestWrap::GetQuery(v8::Local<v8::Name>, const v8::PropertyCallbackInfo<v8::Value>& info) {
+        auto isolate = info.GetIsolate();
+        auto wrapInstance = ObjectWrap::Unwrap<RequestWrap>(info.Holder());
+        auto queryParamsObj = v8::Object::New(isolate);
 
-        reqObjectHandle->Set(methodKey, methodValue);
+        info.GetReturnValue().Set(queryParamsObj);
 
-        /// originalUrl
+        if (!wrapInstance->isValid) {
+            return;
+        }
 
-        auto originalUrlKey = v8::String::NewFromUtf8(
-                isolate, "originalUrl", v8::NewStringType::kNormal).ToLocalChecked();
-        auto originalUrlValue = v8::String::NewFromUtf8(
-                isolate, instance->path.c_str(), v8::NewStringType::kNormal).ToLocalChecked();
+        auto context = isolate->GetCurrentContext();
 
-        reqObjectHandle->Set(originalUrlKey, originalUrlValue);
+        for (const auto& [key, value] : wrapInstance->instance->getQueryParams()) {
+            if (auto v = toJsValue(isolate, value); !v.IsEmpty()) {
+                queryParamsObj->Set(context, JsStrings::value(isolate, key), v).Check();
+            }
+        }
+    }
 
-        /// Relative Path
+    void RequestWrap::GetHostname(v8::Local<v8::Name>, const v8::PropertyCallbackInfo<v8::Value>& info) {
+        auto isolate = info.GetIsolate();
+        auto wrapInstance = ObjectWrap::Unwrap<RequestWrap>(info.Holder());
 
-        auto relativePathKey = v8::String::NewFromUtf8(
-                isolate, "path", v8::NewStringType::kNormal).ToLocalChecked();
-        auto relativePathValue = v8::String::NewFromUtf8(
-                isolate, instance->getRelativePath().c_str(), v8::NewStringType::kNormal).ToLocalChecked();
+        if (!wrapInstance->isValid) {
+            info.GetReturnValue().SetEmptyString();
+            return;
+        }
 
-        reqObjectHandle->Set(relativePathKey, relativePathValue);
+        info.GetReturnValue().Set(JsStrings::value(isolate, wrapInstance->instance->getHost()));
     }
 
     void RequestWrap::Init(v8::Isolate* isolate) {
@@ -484,6 +605,11 @@ namespace nex {
                 isolate, "NRequest", v8::NewStringType::kNormal).ToLocalChecked());
         tpl->InstanceTemplate()->SetInternalFieldCount(1);
 
+        // Built on first read and then kept as plain data properties
+        for (const auto& [key, getter] : lazyFields) {
+            tpl->InstanceTemplate()->SetLazyDataProperty(JsStrings::get(isolate, key), getter);
+        }
+
         NODE_SET_PROTOTYPE_METHOD(tpl, "on", On);
         NODE_SET_PROTOTYPE_METHOD(tpl, "get", Get);
         NODE_SET_PROTOTYPE_METHOD(tpl, "setRequestCustomData", SetCustomData);
@@ -537,30 +663,34 @@ namespace nex {
         v8::String::Utf8Value internalHeaderName(isolate, args[0]);
         std::string headerName(*internalHeaderName);
 
-        auto header = wrapInstance->instance->getHeader(headerName);
+        auto context = isolate->GetCurrentContext();
+        const auto& headers = wrapInstance->instance->headers;
+        auto id = RequestHeaders::lookup(headerName);
+        v8::Local<v8::Value> result;
 
-        if (auto ref = std::get_if<std::string>(&header)) {
-            auto str = v8::String::NewFromUtf8(
-                    isolate, ref->c_str(), v8::NewStringType::kNormal).ToLocalChecked();
+        // Values are read straight from the header block, repeated headers give an array
+        for (const auto& entry : headers.entries()) {
+            if (id != KnownHeader::Unknown ? entry.id != id : !equalsCaseInsensitive(entry.name, headerName)) {
+                continue;
+            }
 
-            args.GetReturnValue().Set(str);
-            return;
-        }
+            auto value = JsStrings::value(isolate, entry.value, headers.getBlock());
 
-        if (auto ref = std::get_if<std::vector<std::string>>(&header)) {
-            v8::Local<v8::Array> headerValues = v8::Array::New(isolate, ref->size());
+            if (result.IsEmpty()) {
+                result = value;
+            } else if (result->IsArray()) {
+                auto values = result.As<v8::Array>();
 
-            if (headerValues.IsEmpty())
-                return;
+                values->Set(context, values->Length(), value).Check();
+            } else {
+                v8::Local<v8::Value> pair[] = {result, value};
 
-            for (size_t i = 0; i < ref->size(); ++i) {
-                auto value = v8::String::NewFromUtf8(
-                        isolate, (*ref)[i].c_str(), v8::NewStringType::kNormal).ToLocalChecked();
-                headerValues->Set(i, value);
+                result = v8::Array::New(isolate, pair, 2);
             }
+        }
 
-            args.GetReturnValue().Set(headerValues);
-            return;
+        if (!result.IsEmpty()) {
+            args.GetReturnValue().Set(result);
         }
     }
 
@@ -579,7 +709,8 @@ namespace nex {
 
         if (eventName == "data") {
             wrapInstance->onDataCallback = callback;
-            wrapInstance->instance->onData([instance = wrapInstance](const std::string& data) {
+            // Chunks reach JS as Buffers over the chunk memory, binary bodies are not transcoded
+            wrapInstance->instance->onChunk([instance = wrapInstance](const BodyChunk& chunk) {
                 if (!instance->isValid) {
                     return;
                 }
@@ -588,10 +719,14 @@ namespace nex {
                 if (!instance->onDataCallback.IsEmpty()) {
                     v8::HandleScope handleScope(isolate);
 
-                    auto str = v8::String::NewFromUtf8(
-                            isolate, data.c_str(), v8::NewStringType::kNormal).ToLocalChecked();
+                    v8::Local<v8::Object> buffer;
+
+                    if (!chunk.toBuffer(isolate).ToLocal(&buffer)) {
+                        return;
+                    }
+
                     auto context = isolate->GetCurrentContext();
-                    v8::Local<v8::Value> argv[] = {str};
+                    v8::Local<v8::Value> argv[] = {buffer};
 
                     instance->onDataCallback.Get(isolate)->Call(context, v8::Null(isolate), 1, argv);
                 }
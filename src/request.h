@@ -3,15 +3,19 @@
 #include <node.h>
 #include <node_object_wrap.h>
 #include "commonHeaders.h"
+#include "bodyChunk.h"
 #include "httpConnection.h"
+#include "jsStrings.h"
+#include "requestHeaders.h"
 
 namespace nex {
 
 class HttpConnection;
 class RequestWrap;
 
-typedef std::function<void(const std::string& )> DataReceivedCallback;
+typedef std::function<void(std::string_view)> DataReceivedCallback;
 typedef std::function<void()> DataEndCallback;
+typedef std::function<void(const BodyChunk&)> BodyChunkCallback;
 
 class AbstractRequest {
 public:
@@ -40,6 +44,9 @@ public:
 
     [[nodiscard]] HttpMethod getHttpMethod() const noexcept override;
     [[nodiscard]] const HeaderValue& getHeader(const std::string& name) override;
+    [[nodiscard]] std::string_view getHeaderView(KnownHeader header) const noexcept;
+    [[nodiscard]] std::string_view getHeaderView(std::string_view name) const noexcept;
+    [[nodiscard]] const RequestHeaders& getHeaders() const noexcept;
     [[nodiscard]] std::string getHost() override;
     [[nodiscard]] std::string getUrl() override;
     [[nodiscard]] const std::string& getPath() const noexcept override;
@@ -61,6 +68,7 @@ public:
 
 private:
     friend class HttpConnection;
+    friend class Http2Connection;
     friend class Pipeline;
     friend class RequestWrap;
 
@@ -74,7 +82,7 @@ private:
 
     explicit Request(uint32_t errorStatusCode);
 
-    void appendHeader(const std::string& name, std::string value);
+    static void appendHeaderValue(HeaderValue& currentValue, std::string_view value);
     void setRelativePath(const std::string& relativePath);
     void setRouteParameter(const std::string& name, RouteParameterValue value);
     void appendQueryParam(const std::string& name, std::string value);
@@ -82,10 +90,18 @@ private:
 
     void invalidate();
 
-    void handleData(const std::string& data);
+    /**
+     * Delivers the body as refcounted chunks instead of views, used for JS listeners
+     */
+    void onChunk(BodyChunkCallback cb);
+
+    void handleData(std::string_view data);
     void handleDataEnd();
 
     void createJsObject();
+    void releaseJsObject();
+    [[nodiscard]] QueryParamMapping& getQueryParams();
+    [[nodiscard]] CookieMapping& getCookies();
     void parseQueryString();
     void parseCookies();
     void prepare();
@@ -93,13 +109,16 @@ private:
     std::shared_ptr<HttpConnection> connection{nullptr};
 
     DataReceivedCallback onDataCallback = nullptr;
+    BodyChunkCallback onChunkCallback = nullptr;
     DataEndCallback onDataEndCallback = nullptr;
 
     bool isAlive = true;
 
     HttpMethod method = GET;
 
-    HeaderMapping headers;
+    RequestHeaders headers;
+    // getHeader() results, materialized on first access
+    HeaderMapping headerValues;
     QueryParamMapping queryParams;
     RouteParamMapping routeParams;
     CookieMapping cookies;
@@ -160,6 +179,23 @@ private:
      */
     void setFields();
 
+    /**
+     * Lazy props, materialized from the native request on first read
+     */
+    static void GetHeaders(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info);
+    static void GetCookies(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info);
+    static void GetParams(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info);
+    static void GetQuery(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info);
+    static void GetHostname(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info);
+
+    static constexpr std::pair<JsKey, v8::AccessorNameGetterCallback> lazyFields[] = {
+        {JsKey::Headers, GetHeaders},
+        {JsKey::Cookies, GetCookies},
+        {JsKey::Params, GetParams},
+        {JsKey::Query, GetQuery},
+        {JsKey::Hostname, GetHostname},
+    };
+
     /**
      * For data transition between native/js middlewares
      */
@@ -0,0 +1,208 @@
+#include "requestHeaders.h"
+
+namespace nex {
+
+    namespace {
+
+        constexpr std::string_view knownHeaderNames[] = {
+            "accept",
+            "accept-charset",
+            "accept-encoding",
+            "accept-language",
+            "access-control-request-headers",
+            "access-control-request-method",
+            "authorization",
+            "cache-control",
+            "connection",
+            "content-encoding",
+            "content-length",
+            "content-type",
+            "cookie",
+            "date",
+            "dnt",
+            "expect",
+            "forwarded",
+            "from",
+            "host",
+            "if-match",
+            "if-modified-since",
+            "if-none-match",
+            "if-range",
+            "if-unmodified-since",
+            "keep-alive",
+            "max-forwards",
+            "origin",
+            "pragma",
+            "proxy-authorization",
+            "range",
+            "referer",
+            "sec-fetch-dest",
+            "sec-fetch-mode",
+            "sec-fetch-site",
+            "sec-fetch-user",
+            "te",
+            "trailer",
+            "transfer-encoding",
+            "upgrade",
+            "upgrade-insecure-requests",
+            "user-agent",
+            "via",
+            "x-forwarded-for",
+            "x-forwarded-host",
+            "x-forwarded-proto",
+            "x-real-ip",
+            "x-requested-with"
+        };
+
+        static_assert(std::size(knownHeaderNames) == RequestHeaders::knownHeaderCount);
+
+        constexpr size_t hashBits = 7;
+        constexpr uint32_t hashMultiplier = 74247;
+
+        constexpr unsigned char toLower(unsigned char c) noexcept {
+            return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+        }
+
+        // Case-insensitive, the multiplier is chosen so that known names don't collide
+        constexpr size_t hashName(std::string_view name) noexcept {
+            uint32_t hash = 0;
+
+            for (auto c : name) {
+                hash = (hash * hashMultiplier) ^ toLower(static_cast<unsigned char>(c));
+            }
+
+            return hash >> (32 - hashBits);
+        }
+
+        constexpr std::array<uint8_t, 1u << hashBits> buildSlots() {
+            std::array<uint8_t, 1u << hashBits> slots{};
+
+            for (auto& slot : slots) {
+                slot = static_cast<uint8_t>(KnownHeader::Unknown);
+            }
+
+            for (size_t i = 0; i < RequestHeaders::knownHeaderCount; ++i) {
+                slots[hashName(knownHeaderNames[i])] = static_cast<uint8_t>(i);
+            }
+
+            return slots;
+        }
+
+        constexpr bool isPerfect() {
+            auto slots = buildSlots();
+            size_t used = 0;
+
+            for (auto slot : slots) {
+                used += slot != static_cast<uint8_t>(KnownHeader::Unknown);
+            }
+
+            return used == RequestHeaders::knownHeaderCount;
+        }
+
+        static_assert(isPerfect(), "Known header names collide, pick another hash multiplier");
+
+        constexpr auto knownHeaderSlots = buildSlots();
+
+    }
+
+    KnownHeader RequestHeaders::lookup(std::string_view name) noexcept {
+        auto id = static_cast<KnownHeader>(knownHeaderSlots[hashName(name)]);
+
+        if (id == KnownHeader::Unknown || !equalsCaseInsensitive(name, knownHeaderNames[static_cast<size_t>(id)])) {
+            return KnownHeader::Unknown;
+        }
+
+        return id;
+    }
+
+    std::string_view RequestHeaders::nameOf(KnownHeader header) noexcept {
+        if (header == KnownHeader::Unknown) {
+            return std::string_view();
+        }
+
+        return knownHeaderNames[static_cast<size_t>(header)];
+    }
+
+    void RequestHeaders::assign(std::string_view headerBlock, const phr_header* headers, size_t count) {
+        // A new copy every time, strings handed out for the previous block may still point into it
+        auto copy = std::make_shared<const std::string>(headerBlock);
+
+        block = copy;
+        list.clear();
+        list.reserve(count);
+        firstIndex.fill(0);
+
+        auto origin = headerBlock.data();
+        auto base = copy->data();
+        auto rebase = [base, origin](const char* data, size_t length) {
+            return std::string_view(base + (data - origin), length);
+        };
+
+        for (size_t i = 0; i < count; ++i) {
+            const auto& header = headers[i];
+
+            if (header.value == nullptr) {
+                continue;
+            }
+
+            // A continuation line carries another value of the previous header
+            if (header.name == nullptr) {
+                if (list.empty()) {
+                    continue;
+                }
+
+                auto previous = list.back();
+                list.push_back(Entry{previous.name, rebase(header.value, header.value_len), previous.id});
+                continue;
+            }
+
+            auto name = rebase(header.name, header.name_len);
+            auto id = lookup(name);
+
+            if (id != KnownHeader::Unknown && !firstIndex[static_cast<size_t>(id)]) {
+                firstIndex[static_cast<size_t>(id)] = static_cast<uint8_t>(list.size() + 1);
+            }
+
+            list.push_back(Entry{name, rebase(header.value, header.value_len), id});
+        }
+    }
+
+    bool RequestHeaders::has(KnownHeader header) const noexcept {
+        return header != KnownHeader::Unknown && firstIndex[static_cast<size_t>(header)];
+    }
+
+    bool RequestHeaders::has(std::string_view name) const noexcept {
+        return find(name) != nullptr;
+    }
+
+    std::string_view RequestHeaders::get(KnownHeader header) const noexcept {
+        if (!has(header)) {
+            return std::string_view();
+        }
+
+        return list[firstIndex[static_cast<size_t>(header)] - 1].value;
+    }
+
+    std::string_view RequestHeaders::get(std::string_view name) const noexcept {
+        auto entry = find(name);
+
+        return entry ? entry->value : std::string_view();
+    }
+
+    const RequestHeaders::Entry* RequestHeaders::find(std::string_view name) const noexcept {
+        auto id = lookup(name);
+
+        if (id != KnownHeader::Unknown) {
+            return has(id) ? &list[firstIndex[static_cast<size_t>(id)] - 1] : nullptr;
+        }
+
+        for (const auto& entry : list) {
+            if (entry.id == KnownHeader::Unknown && equalsCaseInsensitive(entry.name, name)) {
+                return &entry;
+            }
+        }
+
+        return nullptr;
+    }
+
+}
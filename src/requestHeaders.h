@@ -0,0 +1,107 @@
+#pragma once
+
+#include <picohttpparser.h>
+
+#include "commonHeaders.h"
+
+namespace nex {
+
+enum class KnownHeader : uint8_t {
+    Accept,
+    AcceptCharset,
+    AcceptEncoding,
+    AcceptLanguage,
+    AccessControlRequestHeaders,
+    AccessControlRequestMethod,
+    Authorization,
+    CacheControl,
+    Connection,
+    ContentEncoding,
+    ContentLength,
+    ContentType,
+    Cookie,
+    Date,
+    DNT,
+    Expect,
+    Forwarded,
+    From,
+    Host,
+    IfMatch,
+    IfModifiedSince,
+    IfNoneMatch,
+    IfRange,
+    IfUnmodifiedSince,
+    KeepAlive,
+    MaxForwards,
+    Origin,
+    Pragma,
+    ProxyAuthorization,
+    Range,
+    Referer,
+    SecFetchDest,
+    SecFetchMode,
+    SecFetchSite,
+    SecFetchUser,
+    TE,
+    Trailer,
+    TransferEncoding,
+    Upgrade,
+    UpgradeInsecureRequests,
+    UserAgent,
+    Via,
+    XForwardedFor,
+    XForwardedHost,
+    XForwardedProto,
+    XRealIP,
+    XRequestedWith,
+    Unknown
+};
+
+/**
+ * Headers of a single request.
+ *
+ * The raw header block is copied once and every name and value is a view into that copy.
+ * The copy is shared, so JS strings created from the values may outlive the request.
+ * Well-known names are tokenized through a perfect hash and the position of their first
+ * occurrence is kept in a fixed slot, other names are found by scanning the entry list.
+ */
+class RequestHeaders {
+public:
+    struct Entry {
+        std::string_view name;
+        std::string_view value;
+        KnownHeader id;
+    };
+
+    static constexpr size_t knownHeaderCount = static_cast<size_t>(KnownHeader::Unknown);
+
+    [[nodiscard]] static KnownHeader lookup(std::string_view name) noexcept;
+    [[nodiscard]] static std::string_view nameOf(KnownHeader header) noexcept;
+
+    /**
+     * Copies the header block and indexes the headers picohttpparser found inside it
+     */
+    void assign(std::string_view headerBlock, const phr_header* headers, size_t count);
+
+    [[nodiscard]] bool has(KnownHeader header) const noexcept;
+    [[nodiscard]] bool has(std::string_view name) const noexcept;
+
+    /**
+     * First value of the header, empty when absent
+     */
+    [[nodiscard]] std::string_view get(KnownHeader header) const noexcept;
+    [[nodiscard]] std::string_view get(std::string_view name) const noexcept;
+
+    [[nodiscard]] const std::vector<Entry>& entries() const noexcept { return list; }
+    [[nodiscard]] const std::shared_ptr<const std::string>& getBlock() const noexcept { return block; }
+
+private:
+    [[nodiscard]] const Entry* find(std::string_view name) const noexcept;
+
+    std::shared_ptr<const std::string> block{nullptr};
+    std::vector<Entry> list;
+    // Index of the first occurrence plus one, zero when absent
+    std::array<uint8_t, knownHeaderCount> firstIndex{};
+};
+
+}
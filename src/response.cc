@@ -1,7 +1,87 @@
 #include "response.h"
+#include "jsStrings.h"
 
 namespace nex {
 
+    namespace {
+        // Smaller payloads are copied, pinning them costs more than the copy
+        constexpr size_t minPinnedLength = 1024;
+
+        bool isAscii(const char* data, size_t length) noexcept {
+            for (size_t i = 0; i < length; ++i) {
+                if (static_cast<unsigned char>(data[i]) > 0x7f) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * Keeps a JS value, and the memory it owns, alive until the write that sends it completes
+         */
+        std::shared_ptr<const void> pin(v8::Isolate* isolate, v8::Local<v8::Value> value) {
+            return std::make_shared<v8::Global<v8::Value>>(isolate, value);
+        }
+
+        /**
+         * Body of a send()/write() argument. Buffers and typed arrays are sent from their backing
+         * store, strings are encoded once straight into the output chunk.
+         */
+        bool toOutputChunk(v8::Isolate* isolate, v8::Local<v8::Value> value, OutputChunk& chunk) {
+            if (value->IsArrayBufferView()) {
+                auto view = value.As<v8::ArrayBufferView>();
+                auto length = view->ByteLength();
+
+                if (length < minPinnedLength) {
+                    std::string data(length, '\0');
+
+                    view->CopyContents(data.data(), length);
+                    chunk = OutputChunk::take(std::move(data));
+
+                    return true;
+                }
+
+                auto contents = view->Buffer()->GetContents();
+                auto data = static_cast<const char*>(contents.Data()) + view->ByteOffset();
+
+                chunk = OutputChunk{data, length, pin(isolate, value)};
+
+                return true;
+            }
+
+            if (!value->IsString()) {
+                return false;
+            }
+
+            auto str = value.As<v8::String>();
+
+            // External strings never move, ASCII ones are their own UTF-8 encoding
+            if (str->IsExternalOneByte()) {
+                auto resource = str->GetExternalOneByteStringResource();
+
+                if (resource->length() >= minPinnedLength && isAscii(resource->data(), resource->length())) {
+                    chunk = OutputChunk{resource->data(), resource->length(), pin(isolate, value)};
+
+                    return true;
+                }
+            }
+
+            std::string data(static_cast<size_t>(str->Utf8Length(isolate)), '\0');
+
+            str->WriteUtf8(
+                    isolate,
+                    data.data(),
+                    static_cast<int>(data.length()),
+                    nullptr,
+                    v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8
+            );
+            chunk = OutputChunk::take(std::move(data));
+
+            return true;
+        }
+    }
+
     // Response
 
     Response::Response(
@@ -9,6 +89,7 @@ namespace nex {
         v8::Isolate* isolate,
         uint32_t httpMinorVersion
     ) : httpConnection(std::move(httpConnection)),
+        context(this->httpConnection->context),
         minorVersion(httpMinorVersion),
         isolate(isolate)
     {
@@ -18,9 +99,7 @@ namespace nex {
     void Response::invalidate() {
         isAlive = false;
 
-        if (jsObj) {
-            jsObj->invalidate();
-        }
+        releaseJsObject();
     }
 
     void Response::end() {
@@ -33,13 +112,34 @@ namespace nex {
             return;
         }
 
+        // Ended once the body is compressed or sent
+        if (bodyPending) {
+            return;
+        }
+
         if (!headersSent) {
-            contentLength = 0;
+            contentLength = uint64_t(0);
             sendHeaders();
+        } else if (encoder) {
+            std::string tail;
+
+            if (encoder->encode(std::string_view(), true, tail)) {
+                queueBody(OutputChunk::take(std::move(tail)));
+            }
         }
 
+        releaseEncoder();
+
         if (headersSent && isChunkedTransfer) {
-            writeInternal("");
+            httpConnection->output.append(OutputChunk::borrow(LAST_CHUNK, sizeof(LAST_CHUNK) - 1));
+        }
+
+        // A stream is submitted at its end, so that a whole body leaves with END_STREAM on its last frame.
+        // It is moved out since the response may be released once the exchange completes.
+        auto http2Stream = std::move(stream);
+
+        if (!http2Stream) {
+            flushOutput();
         }
 
         invalidate();
@@ -50,20 +150,61 @@ namespace nex {
             pipelineEndCallback = nullptr;
         }
 
+        if (http2Stream) {
+            http2Stream->end();
+            return;
+        }
+
         httpConnection->end();
     }
 
     void Response::send(const std::string& data) {
-        if (!isAlive) {
+        if (!isAlive || bodyPending) {
+            return;
+        }
+
+        sendBody(OutputChunk::copy(data));
+    }
+
+    void Response::send(std::string&& data) {
+        if (!isAlive || bodyPending) {
+            return;
+        }
+
+        sendBody(OutputChunk::take(std::move(data)));
+    }
+
+    void Response::send(OutputChunk body) {
+        if (!isAlive || bodyPending) {
+            return;
+        }
+
+        sendBody(std::move(body));
+    }
+
+    void Response::sendBody(OutputChunk body) {
+        if (!headersSent && prepareEncoding(&body)) {
+            auto threadPoolThreshold = compressionOptions.threadPoolThreshold;
+
+            if (threadPoolThreshold && body.length >= threadPoolThreshold) {
+                encodeOnThreadPool(std::move(body));
+                return;
+            }
+
+            std::string encoded;
+            auto isEncoded = encoder->encode(std::string_view(body.data, body.length), true, encoded);
+
+            completeEncoding(isEncoded ? OutputChunk::take(std::move(encoded)) : std::move(body), isEncoded);
             return;
         }
 
         if (!headersSent) {
-            contentLength = data.length();
+            contentLength = static_cast<uint64_t>(body.length);
             sendHeaders();
         }
 
-        writeInternal(data);
+        // Status line, headers and body leave in a single coalesced write
+        queueBody(std::move(body));
 
         end();
     }
@@ -75,28 +216,44 @@ namespace nex {
 
         updateHeadersBeforeSending();
 
-        std::stringstream buffer;
+        auto& headerCache = context->getHeaderCache();
 
-        buffer << "HTTP/1." << minorVersion << " " << statusCode << " "
-               << getStatusTextByCode(statusCode) << CRLF;
+        if (stream) {
+            stream->setHeaders(statusCode, headers, headerCache.getDateValue());
+            headersSent = true;
+            return;
+        }
+
+        std::string buffer;
+        buffer.reserve(512);
+
+        buffer.append(headerCache.getStatusLine(minorVersion, statusCode));
+
+        if (headers.find("Date") == headers.end()) {
+            buffer.append(headerCache.getDateLine());
+        }
+
+        if (headers.find("Connection") == headers.end()) {
+            buffer.append(headerCache.getConnectionLines());
+        }
 
         for (const auto& [key, value]: headers) {
             if (auto ref = std::get_if<std::string>(&value)) {
-                buffer << key << ": " << *ref << CRLF;
+                buffer.append(key).append(": ").append(*ref).append(CRLF);
                 continue;
             }
 
             if (auto ref = std::get_if<std::vector<std::string>>(&value)) {
                 for (auto& v : *ref) {
-                    buffer << key << ": " << v << CRLF;
+                    buffer.append(key).append(": ").append(v).append(CRLF);
                 }
                 continue;
             }
         }
 
-        buffer << CRLF;
+        buffer.append(CRLF);
 
-        writeRaw(buffer.str());
+        httpConnection->output.append(std::move(buffer));
         headersSent = true;
     }
 
@@ -112,30 +269,45 @@ namespace nex {
         return headersSent;
     }
 
-    void Response::writeRaw(const std::string& data) {
-        auto size = data.length();
-        auto dataPtr = std::make_unique<char[]>(size + 1);
-        std::copy(data.begin(), data.end(), dataPtr.get());
-        dataPtr[size] = '\0';
+    void Response::flushOutput() {
+        if (stream) {
+            stream->flush();
+            return;
+        }
 
-        httpConnection->client->write(std::move(dataPtr), size);
+        httpConnection->scheduleFlush();
     }
 
-    void Response::writeInternal(const std::string& data) {
+    void Response::queueBody(OutputChunk data) {
+        if (stream) {
+            stream->write(std::move(data));
+            return;
+        }
+
+        auto& output = httpConnection->output;
+
         if (!isChunkedTransfer) {
-            writeRaw(data);
+            output.append(std::move(data));
             return;
         }
 
-        std::stringstream buffer;
+        if (!data.length) {
+            return;
+        }
 
-        buffer << std::hex << data.length() << CRLF
-            << data << CRLF;
+        char chunkSize[20];
+        auto chunkSizeLength = snprintf(chunkSize, sizeof(chunkSize), "%zx\r\n", data.length);
 
-        writeRaw(buffer.str());
+        output.append(std::string(chunkSize, chunkSizeLength));
+        output.append(std::move(data));
+        output.append(OutputChunk::borrow(CRLF, sizeof(CRLF) - 1));
     }
 
     const HeaderValue& Response::getHeader(const std::string& name) {
+        if (headers.find(name) == headers.end()) {
+            materializeBasicHeader(name);
+        }
+
         return headers[name];
     }
 
@@ -173,33 +345,251 @@ namespace nex {
     }
 
     void Response::write(const std::string& data) {
-        if (!isAlive) {
+        if (!isAlive || bodyPending) {
             return;
         }
 
+        writeBody(OutputChunk::copy(data));
+    }
+
+    void Response::write(std::string&& data) {
+        if (!isAlive || bodyPending) {
+            return;
+        }
+
+        writeBody(OutputChunk::take(std::move(data)));
+    }
+
+    void Response::write(OutputChunk data) {
+        if (!isAlive || bodyPending) {
+            return;
+        }
+
+        writeBody(std::move(data));
+    }
+
+    void Response::writeBody(OutputChunk data) {
         if (!headersSent) {
-            if (httpConnection->config->persistentConnections)
+            // HTTP/2 frames the body itself
+            if (httpConnection->config->persistentConnections && !stream)
                 isChunkedTransfer = true;
+            prepareEncoding(nullptr);
             sendHeaders();
         }
 
-        writeInternal(data);
+        if (encoder) {
+            std::string encoded;
+
+            // The headers are out already, a broken stream can only be cut short
+            if (!encoder->encode(std::string_view(data.data, data.length), false, encoded)) {
+                releaseEncoder();
+                return;
+            }
+
+            data = OutputChunk::take(std::move(encoded));
+        }
+
+        queueBody(std::move(data));
+        flushOutput();
     }
 
     void Response::sendStatus(uint32_t code) {
-        if (!isAlive) {
+        if (!isAlive || bodyPending) {
             return;
         }
 
         if (!headersSent) {
             sendHeaders();
+            flushOutput();
         }
     }
 
     Response::~Response() {
-        if (jsObj) {
-            jsObj->invalidate();
+        releaseJsObject();
+        releaseEncoder();
+    }
+
+    void Response::setContentCoding(ContentCoding coding, const CompressionOptions& options) {
+        if (!isAlive || headersSent || bodyPending || coding == ContentCoding::Identity) {
+            return;
+        }
+
+        releaseEncoder();
+        encoder = context->getEncoderPool().acquire(coding, options);
+        compressionOptions = options;
+    }
+
+    bool Response::prepareEncoding(const OutputChunk* body) {
+        if (!encoder) {
+            return false;
+        }
+
+        auto contentType = headers.find("Content-Type");
+        auto compressible = contentType != headers.end()
+            && std::holds_alternative<std::string>(contentType->second)
+            && isCompressible(std::get<std::string>(contentType->second));
+
+        // Caches must not hand a compressed body to clients that can't decode it
+        if (compressible) {
+            auto vary = headers.find("Vary");
+            auto varyValue = vary != headers.end() ? std::get_if<std::string>(&vary->second) : nullptr;
+
+            if (!varyValue || varyValue->find("Accept-Encoding") == std::string::npos) {
+                appendHeader("Vary", "Accept-Encoding");
+            }
+        }
+
+        if (
+            !compressible
+            || statusCode == 204
+            || statusCode == 304
+            || headers.find("Content-Encoding") != headers.end()
+            || (body && body->length < compressionOptions.threshold)
+        ) {
+            releaseEncoder();
+            return false;
+        }
+
+        headers["Content-Encoding"] = std::string(getCodingName(encoder->getCoding()));
+        headers.erase("Content-Length");
+
+        // The encoded bytes differ from what a strong ETag was computed over
+        auto etag = headers.find("ETag");
+
+        if (etag != headers.end()) {
+            auto etagValue = std::get_if<std::string>(&etag->second);
+
+            if (etagValue && etagValue->compare(0, 2, "W/") != 0) {
+                etagValue->insert(0, "W/");
+            }
         }
+
+        return true;
+    }
+
+    void Response::encodeOnThreadPool(OutputChunk body) {
+        auto input = std::make_shared<OutputChunk>(std::move(body));
+        auto output = std::make_shared<std::string>();
+        auto isEncoded = std::make_shared<bool>(false);
+        auto loop = context->getLoop();
+
+        // The encoder stays with the response, which is kept alive until the task is done
+        auto work = loop->resource<uvw::WorkReq>([encoder = encoder.get(), input, output, isEncoded]() {
+            *isEncoded = encoder->encode(std::string_view(input->data, input->length), true, *output);
+        });
+
+        auto self = shared_from_this();
+
+        work->once<uvw::WorkEvent>([self, input, output, isEncoded](const uvw::WorkEvent&, uvw::WorkReq&) {
+            self->completeEncoding(
+                *isEncoded ? OutputChunk::take(std::move(*output)) : std::move(*input),
+                *isEncoded
+            );
+        });
+
+        work->once<uvw::ErrorEvent>([self, input](const uvw::ErrorEvent&, uvw::WorkReq&) {
+            self->completeEncoding(std::move(*input), false);
+        });
+
+        bodyPending = true;
+        work->queue();
+    }
+
+    void Response::completeEncoding(OutputChunk body, bool encoded) {
+        bodyPending = false;
+
+        if (!encoded) {
+            headers.erase("Content-Encoding");
+        }
+
+        releaseEncoder();
+
+        if (!isAlive) {
+            end();
+            return;
+        }
+
+        sendBody(std::move(body));
+    }
+
+    void Response::sendFile(std::shared_ptr<const FileDescriptor> file, uint64_t offset, uint64_t length) {
+        std::vector<FileSegment> segments;
+
+        segments.push_back(FileSegment{std::move(file), offset, length, OutputChunk()});
+        sendSegments(std::move(segments));
+    }
+
+    void Response::sendSegments(std::vector<FileSegment> segments) {
+        if (!isAlive || headersSent || bodyPending) {
+            return;
+        }
+
+        // Files go out as they are on disk
+        releaseEncoder();
+
+        uint64_t length = 0;
+
+        for (const auto& segment : segments) {
+            length += segment.file ? segment.length : segment.data.length;
+        }
+
+        contentLength = length;
+        sendHeaders();
+
+        if (!length) {
+            end();
+            return;
+        }
+
+        // DATA frames are cut from the segments, sendfile can't be used under HTTP/2 framing
+        if (stream) {
+            for (auto& segment : segments) {
+                stream->write(std::move(segment));
+            }
+
+            end();
+            return;
+        }
+
+        auto self = shared_from_this();
+        auto sender = std::make_shared<FileSender>(self, std::move(segments), [self](bool sent) {
+            self->completeFileSending(sent);
+        });
+
+        bodyPending = true;
+        sender->start();
+    }
+
+    void Response::sendHead(uint64_t length) {
+        if (!isAlive || headersSent || bodyPending) {
+            return;
+        }
+
+        releaseEncoder();
+
+        contentLength = length;
+        sendHeaders();
+        end();
+    }
+
+    void Response::completeFileSending(bool sent) {
+        bodyPending = false;
+
+        // Content-Length is out already, a short body can only be told by closing the connection
+        if (!sent && isAlive) {
+            httpConnection->close();
+        }
+
+        end();
+    }
+
+    void Response::releaseEncoder() noexcept {
+        if (!encoder || bodyPending) {
+            return;
+        }
+
+        context->getEncoderPool().release(std::move(encoder));
+        encoder = nullptr;
     }
 
     void Response::setBasicHeaders() {
@@ -207,16 +597,24 @@ namespace nex {
             return;
         }
 
-        headers["Date"] = getStandardizedTime();
+        // Date, Connection and Keep-Alive come pre-serialized from the loop's header cache
+        // unless they are read or overridden
         headers["Content-Type"] = "text/plain; charset=utf-8";
+    }
 
-        if (httpConnection->config->persistentConnections) {
-            headers["Connection"] = "keep-alive";
-            headers["Keep-Alive"] = "timeout=" +
-                    std::to_string(httpConnection->config->keepAliveTimeout / 1000) +
-                    ", max=" + std::to_string(httpConnection->config->maxRequestsPerConnection);
-        } else {
-            headers["Connection"] = "close";
+    void Response::materializeBasicHeader(const std::string& name) {
+        if (headers.find(name) != headers.end()) {
+            return;
+        }
+
+        auto& headerCache = context->getHeaderCache();
+
+        if (equalsCaseInsensitive(name, "Date")) {
+            headers["Date"] = headerCache.getDateValue();
+        } else if (equalsCaseInsensitive(name, "Connection")) {
+            headers["Connection"] = headerCache.getConnectionValue();
+        } else if (equalsCaseInsensitive(name, "Keep-Alive") && httpConnection->config->persistentConnections) {
+            headers["Keep-Alive"] = headerCache.getKeepAliveValue();
         }
     }
 
@@ -225,16 +623,23 @@ namespace nex {
             return;
         }
 
+        // Cached connection lines carry both headers, an override of either one is serialized from the map
+        if ((headers.find("Connection") == headers.end()) != (headers.find("Keep-Alive") == headers.end())) {
+            materializeBasicHeader("Connection");
+            materializeBasicHeader("Keep-Alive");
+        }
+
         if (isChunkedTransfer) {
             headers["Transfer-Encoding"] = "chunked";
-        } else if (auto length = std::get_if<uint32_t>(&contentLength)) {
+        } else if (auto length = std::get_if<uint64_t>(&contentLength)) {
             headers["Content-Length"] = std::to_string(*length);
         } else {
             headers["Transfer-Encoding"] = "identity";
         }
 
         if (auto contentType = std::get_if<std::string>(&headers["Content-Type"])) {
-            if (contentType->find("charset") == std::string::npos) {
+            // A charset means nothing to binary types like images
+            if (contentType->find("charset") == std::string::npos && isCompressible(*contentType)) {
                 headers["Content-Type"] = *contentType + "; charset=utf-8";
             }
         }
@@ -257,6 +662,23 @@ namespace nex {
         }
     }
 
+    void Response::releaseJsObject() {
+        if (!jsObj) {
+            return;
+        }
+
+        jsObj->invalidate();
+        jsObj = nullptr;
+    }
+
+    LoopContext* Response::getLoopContext() const noexcept {
+        if (!isAlive) {
+            return nullptr;
+        }
+
+        return context.get();
+    }
+
     v8::Persistent<v8::Object>& Response::getJsObject() {
         if (!isAlive) {
             throw std::exception();
@@ -280,6 +702,7 @@ namespace nex {
         }
 
         isValid = false;
+        instance = nullptr;
         Unref();
     }
 
@@ -291,8 +714,7 @@ namespace nex {
         auto isolate = instance->isolate;
         auto reqObjectHandle = handle(isolate);
 
-        auto headersSentKey = v8::String::NewFromUtf8(
-                isolate, "headersSent", v8::NewStringType::kNormal).ToLocalChecked();
+        auto headersSentKey = JsStrings::get(isolate, JsKey::HeadersSent);
         auto headersSentValue = v8::Boolean::New(isolate, instance->areHeadersSent());
 
         reqObjectHandle->Set(headersSentKey, headersSentValue);
@@ -462,20 +884,13 @@ namespace nex {
             return;
         }
 
-        auto domainKey = v8::String::NewFromUtf8(
-                isolate, "domain", v8::NewStringType::kNormal).ToLocalChecked();
-        auto expiresKey = v8::String::NewFromUtf8(
-                isolate, "expires", v8::NewStringType::kNormal).ToLocalChecked();
-        auto httpOnlyKey = v8::String::NewFromUtf8(
-                isolate, "httpOnly", v8::NewStringType::kNormal).ToLocalChecked();
-        auto maxAgeKey = v8::String::NewFromUtf8(
-                isolate, "maxAge", v8::NewStringType::kNormal).ToLocalChecked();
-        auto pathKey = v8::String::NewFromUtf8(
-                isolate, "path", v8::NewStringType::kNormal).ToLocalChecked();
-        auto secureKey = v8::String::NewFromUtf8(
-                isolate, "secure", v8::NewStringType::kNormal).ToLocalChecked();
-        auto sameSiteKey = v8::String::NewFromUtf8(
-                isolate, "sameSite", v8::NewStringType::kNormal).ToLocalChecked();
+        auto domainKey = JsStrings::get(isolate, JsKey::Domain);
+        auto expiresKey = JsStrings::get(isolate, JsKey::Expires);
+        auto httpOnlyKey = JsStrings::get(isolate, JsKey::HttpOnly);
+        auto maxAgeKey = JsStrings::get(isolate, JsKey::MaxAge);
+        auto pathKey = JsStrings::get(isolate, JsKey::Path);
+        auto secureKey = JsStrings::get(isolate, JsKey::Secure);
+        auto sameSiteKey = JsStrings::get(isolate, JsKey::SameSite);
 
         auto domain = cookieOptions->Get(domainKey);
         auto expires = cookieOptions->Get(expiresKey);
@@ -590,20 +1005,13 @@ namespace nex {
             return;
         }
 
-        auto domainKey = v8::String::NewFromUtf8(
-                isolate, "domain", v8::NewStringType::kNormal).ToLocalChecked();
-        auto expiresKey = v8::String::NewFromUtf8(
-                isolate, "expires", v8::NewStringType::kNormal).ToLocalChecked();
-        auto httpOnlyKey = v8::String::NewFromUtf8(
-                isolate, "httpOnly", v8::NewStringType::kNormal).ToLocalChecked();
-        auto maxAgeKey = v8::String::NewFromUtf8(
-                isolate, "maxAge", v8::NewStringType::kNormal).ToLocalChecked();
-        auto pathKey = v8::String::NewFromUtf8(
-                isolate, "path", v8::NewStringType::kNormal).ToLocalChecked();
-        auto secureKey = v8::String::NewFromUtf8(
-                isolate, "secure", v8::NewStringType::kNormal).ToLocalChecked();
-        auto sameSiteKey = v8::String::NewFromUtf8(
-                isolate, "sameSite", v8::NewStringType::kNormal).ToLocalChecked();
+        auto domainKey = JsStrings::get(isolate, JsKey::Domain);
+        auto expiresKey = JsStrings::get(isolate, JsKey::Expires);
+        auto httpOnlyKey = JsStrings::get(isolate, JsKey::HttpOnly);
+        auto maxAgeKey = JsStrings::get(isolate, JsKey::MaxAge);
+        auto pathKey = JsStrings::get(isolate, JsKey::Path);
+        auto secureKey = JsStrings::get(isolate, JsKey::Secure);
+        auto sameSiteKey = JsStrings::get(isolate, JsKey::SameSite);
 
         auto domain = cookieOptions->Get(domainKey);
         auto expires = cookieOptions->Get(expiresKey);
@@ -695,12 +1103,13 @@ namespace nex {
         v8::Isolate* isolate = args.GetIsolate();
         auto wrapInstance = ObjectWrap::Unwrap<ResponseWrap>(args.Holder());
 
-        if (!wrapInstance->isValid || !args[0]->IsString()) {
+        OutputChunk body;
+
+        if (!wrapInstance->isValid || !toOutputChunk(isolate, args[0], body)) {
             return;
         }
 
-        v8::String::Utf8Value internalData(isolate, args[0]);
-        wrapInstance->instance->send(std::string(*internalData));
+        wrapInstance->instance->send(std::move(body));
     }
 
     void ResponseWrap::SendStatus(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -724,12 +1133,13 @@ namespace nex {
         v8::Isolate* isolate = args.GetIsolate();
         auto wrapInstance = ObjectWrap::Unwrap<ResponseWrap>(args.Holder());
 
-        if (!wrapInstance->isValid || !args[0]->IsString()) {
+        OutputChunk data;
+
+        if (!wrapInstance->isValid || !toOutputChunk(isolate, args[0], data)) {
             return;
         }
 
-        v8::String::Utf8Value internalData(isolate, args[0]);
-        wrapInstance->instance->write(std::string(*internalData));
+        wrapInstance->instance->write(std::move(data));
     }
 
     void ResponseWrap::SetStatus(const v8::FunctionCallbackInfo<v8::Value>& args) {
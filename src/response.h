@@ -2,18 +2,22 @@
 
 
 #include <sstream>
-#include <iomanip>
 #include <node.h>
 #include <node_object_wrap.h>
 
 #include "commonHeaders.h"
+#include "bodyEncoder.h"
+#include "fileSender.h"
+#include "outputBatch.h"
 #include "httpConnection.h"
 
 namespace nex {
 
 inline const char CRLF[] = "\r\n";
+inline const char LAST_CHUNK[] = "0\r\n\r\n";
 
 class Router;
+class LoopContext;
 class ResponseWrap;
 class HttpConnection;
 
@@ -32,15 +36,17 @@ public:
     virtual void setCookie(const std::string& name, ResponseCookieValue value) = 0;
     virtual void clearCookie(const std::string& name, ResponseCookieValue value) = 0;
     virtual void write(const std::string& data) = 0;
+    virtual void write(std::string&& data) = 0;
     virtual void sendStatus(uint32_t code) = 0;
     virtual void setStatus(uint32_t code) = 0;
     virtual void end() = 0;
 
     virtual void send(const std::string& data) = 0;
+    virtual void send(std::string&& data) = 0;
 };
 
 
-class Response final : public AbstractResponse {
+class Response final : public AbstractResponse, public std::enable_shared_from_this<Response> {
 public:
 
     [[nodiscard]] const HeaderValue& getHeader(const std::string& name) override;
@@ -53,16 +59,56 @@ public:
     void setCookie(const std::string& name, ResponseCookieValue value) override;
     void clearCookie(const std::string& name, ResponseCookieValue value) override;
     void write(const std::string& data) override;
+    void write(std::string&& data) override;
     void sendStatus(uint32_t code) override;
     void setStatus(uint32_t code) override;
     void end() override;
 
     void send(const std::string& data) override;
+    void send(std::string&& data) override;
+
+    /**
+     * Sends or writes a chunk as is, its owner is kept until the write completes
+     */
+    void send(OutputChunk body);
+    void write(OutputChunk data);
+
+    /**
+     * False once the response has ended or its connection is gone
+     */
+    [[nodiscard]] bool isWritable() const noexcept { return isAlive; }
+
+    /**
+     * Resources of the event loop serving the response, null once its connection is gone
+     */
+    [[nodiscard]] LoopContext* getLoopContext() const noexcept;
+
+    /**
+     * Sends a byte range of an open file as the body, with sendfile(2) instead of through memory
+     */
+    void sendFile(std::shared_ptr<const FileDescriptor> file, uint64_t offset, uint64_t length);
+
+    /**
+     * Sends file ranges and pieces of output in a row as the body, e.g. a multipart/byteranges one
+     */
+    void sendSegments(std::vector<FileSegment> segments);
+
+    /**
+     * Sends the headers of a `contentLength` long body without the body, as a response to HEAD
+     */
+    void sendHead(uint64_t contentLength);
+
+    /**
+     * Compresses the body with `coding` if it turns out to be worth it once the headers go out
+     */
+    void setContentCoding(ContentCoding coding, const CompressionOptions& options);
 
     ~Response();
 
 private:
+    friend class FileSender;
     friend class HttpConnection;
+    friend class Http2Connection;
     friend class Pipeline;
     friend class ResponseWrap;
 
@@ -73,16 +119,34 @@ private:
     );
 
     void sendHeaders();
+    void sendBody(OutputChunk body);
+    void writeBody(OutputChunk data);
 
     void invalidate();
 
-    void writeRaw(const std::string& data);
-    void writeInternal(const std::string& data);
+    void queueBody(OutputChunk data);
+    void flushOutput();
     void setBasicHeaders();
+    void materializeBasicHeader(const std::string& name);
     void updateHeadersBeforeSending();
     void createJsObject();
+    void releaseJsObject();
+
+    /**
+     * Adds the encoding headers when the body should be encoded, `body` is null for streamed ones
+     */
+    bool prepareEncoding(const OutputChunk* body);
+    void encodeOnThreadPool(OutputChunk body);
+    void completeEncoding(OutputChunk body, bool encoded);
+    void releaseEncoder() noexcept;
+    void completeFileSending(bool sent);
 
+    // The connection's thisRef doesn't keep it alive, it may be gone once the response is invalidated
     std::shared_ptr<HttpConnection> httpConnection;
+    // Outlives the connection, so that the encoder goes back to the pool of its loop
+    std::shared_ptr<LoopContext> context;
+    // Frames the response when it is served over HTTP/2
+    std::shared_ptr<Http2Stream> stream{nullptr};
 
     std::function<void()>* pipelineEndCallback = nullptr;
 
@@ -91,19 +155,23 @@ private:
 
     uint32_t statusCode = 500;
     uint32_t minorVersion = 1;
-    std::variant<std::monostate, uint32_t> contentLength;
+    std::variant<std::monostate, uint64_t> contentLength;
 
     bool isAlive = true;
     bool headersSent = false;
     bool isChunkedTransfer = false;
 
+    std::unique_ptr<BodyEncoder> encoder{nullptr};
+    CompressionOptions compressionOptions;
+    // The body is being compressed on the threadpool or sent from a file, the response waits for it
+    bool bodyPending = false;
+
     v8::Isolate* isolate;
     ResponseWrap* jsObj = nullptr;
 };
 
 class ResponseWrap: public node::ObjectWrap {
 public:
-
     void invalidate();
     void updateFields();
 
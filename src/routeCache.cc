@@ -0,0 +1,88 @@
+#include "routeCache.h"
+
+namespace nex {
+
+    size_t RouteCache::KeyHash::operator()(const Key& key) const noexcept {
+        return std::hash<std::string_view>()(key.path) ^ (static_cast<size_t>(key.method) * 31);
+    }
+
+    RouteCache::RouteCache(size_t capacity)
+        : capacity(capacity)
+    {
+        index.reserve(capacity);
+    }
+
+    const RouteCache::Entry* RouteCache::find(HttpMethod method, std::string_view path, const RouteTable* routeTable) {
+        auto it = index.find(Key{method, path});
+
+        if (it == index.end()) {
+            stats->misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        auto entry = it->second;
+
+        if (entry->routeTable.get() != routeTable) {
+            erase(entry);
+            stats->misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        entries.splice(entries.begin(), entries, entry);
+        stats->hits.fetch_add(1, std::memory_order_relaxed);
+
+        return &*entry;
+    }
+
+    void RouteCache::insert(
+        HttpMethod method,
+        std::string_view path,
+        std::shared_ptr<const RouteTable> routeTable,
+        const std::vector<RouteMatch>& matches,
+        const std::vector<std::string_view>& captures
+    ) {
+        if (!capacity) {
+            return;
+        }
+
+        auto existing = index.find(Key{method, path});
+
+        if (existing != index.end()) {
+            erase(existing->second);
+        }
+
+        // The least recently used entry is reused for the new one
+        if (entries.size() >= capacity) {
+            auto last = std::prev(entries.end());
+
+            index.erase(Key{last->method, last->path});
+            entries.splice(entries.begin(), entries, last);
+            stats->evictions.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            entries.emplace_front();
+        }
+
+        auto& entry = entries.front();
+
+        entry.method = method;
+        entry.path.assign(path.data(), path.length());
+        entry.routeTable = std::move(routeTable);
+        entry.matches = matches;
+        entry.captures.clear();
+
+        for (const auto& capture : captures) {
+            entry.captures.emplace_back(
+                static_cast<uint32_t>(capture.data() - path.data()),
+                static_cast<uint32_t>(capture.length())
+            );
+        }
+
+        index.emplace(Key{method, entry.path}, entries.begin());
+    }
+
+    void RouteCache::erase(std::list<Entry>::iterator entry) {
+        index.erase(Key{entry->method, entry->path});
+        entries.erase(entry);
+    }
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "commonHeaders.h"
+#include "routeTree.h"
+
+namespace nex {
+
+class RouteTable;
+
+/**
+ * Counters of one loop's route cache, read from the main thread.
+ */
+struct RouteCacheStats {
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+};
+
+/**
+ * Bounded LRU of top-level route matches of one event loop, keyed by method and path.
+ * Entries remember the dispatch table they were matched against and are dropped once
+ * the routes change and the table is replaced.
+ */
+class RouteCache {
+public:
+    struct Entry {
+        HttpMethod method;
+        std::string path;
+        std::shared_ptr<const RouteTable> routeTable{nullptr};
+        std::vector<RouteMatch> matches;
+        // Offset and length of every captured parameter value in the path
+        std::vector<std::pair<uint32_t, uint32_t>> captures;
+    };
+
+    explicit RouteCache(size_t capacity);
+
+    [[nodiscard]] bool isEnabled() const noexcept { return capacity > 0; }
+    [[nodiscard]] const std::shared_ptr<RouteCacheStats>& getStats() const noexcept { return stats; }
+
+    [[nodiscard]] const Entry* find(HttpMethod method, std::string_view path, const RouteTable* routeTable);
+
+    /**
+     * Captures must be views into the path
+     */
+    void insert(
+        HttpMethod method,
+        std::string_view path,
+        std::shared_ptr<const RouteTable> routeTable,
+        const std::vector<RouteMatch>& matches,
+        const std::vector<std::string_view>& captures
+    );
+
+private:
+    struct Key {
+        HttpMethod method;
+        std::string_view path;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const noexcept;
+    };
+
+    struct KeyEqual {
+        bool operator()(const Key& first, const Key& second) const noexcept {
+            return first.method == second.method && first.path == second.path;
+        }
+    };
+
+    void erase(std::list<Entry>::iterator entry);
+
+    // Most recently used first, keys of the index are views into the entries' paths
+    std::list<Entry> entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash, KeyEqual> index;
+    size_t capacity;
+    std::shared_ptr<RouteCacheStats> stats{std::make_shared<RouteCacheStats>()};
+};
+
+}
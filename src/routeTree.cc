@@ -0,0 +1,259 @@
+#include "routeTree.h"
+
+namespace nex {
+
+    namespace {
+
+        bool isParameterName(std::string_view name) noexcept {
+            if (name.empty()) {
+                return false;
+            }
+
+            for (auto c : name) {
+                if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool isLiteral(std::string_view text) noexcept {
+            return text.find_first_of(":*?+(){}\\") == std::string_view::npos;
+        }
+
+        bool isNumber(std::string_view text) noexcept {
+            if (text.empty()) {
+                return false;
+            }
+
+            for (auto c : text) {
+                if (c < '0' || c > '9') {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    }
+
+    bool RouteTree::insert(
+        std::string_view pattern,
+        size_t parameterCount,
+        bool partial,
+        size_t index,
+        size_t mountSegments
+    ) {
+        std::vector<Segment> segments;
+
+        if (!parse(pattern, parameterCount, segments) || mountSegments > segments.size()) {
+            return false;
+        }
+
+        auto node = &root;
+
+        for (const auto& segment : segments) {
+            if (segment.type == SegmentType::Parameter || segment.type == SegmentType::NumericParameter) {
+                auto& child = segment.type == SegmentType::Parameter ? node->parameter : node->numericParameter;
+
+                if (!child) {
+                    child = std::make_unique<Node>();
+                }
+
+                node = child.get();
+                continue;
+            }
+
+            std::string literal(segment.text);
+            stringToLower(literal);
+
+            auto it = std::lower_bound(
+                node->literals.begin(),
+                node->literals.end(),
+                literal,
+                [](const auto& entry, const std::string& key) { return entry.first < key; }
+            );
+
+            if (it == node->literals.end() || it->first != literal) {
+                it = node->literals.emplace(it, std::move(literal), std::make_unique<Node>());
+            }
+
+            node = it->second.get();
+        }
+
+        (partial ? node->partialRoutes : node->wholeRoutes).push_back(RouteReference{index, mountSegments});
+
+        return true;
+    }
+
+    bool RouteTree::canCompile(std::string_view pattern, size_t parameterCount) {
+        std::vector<Segment> segments;
+
+        return parse(pattern, parameterCount, segments);
+    }
+
+    void RouteTree::match(
+        std::string_view path,
+        std::vector<RouteMatch>& matches,
+        std::vector<std::string_view>& captures
+    ) const {
+        std::vector<size_t> positions;
+        std::vector<std::string_view> stack;
+
+        collect(root, path, 0, positions, stack, matches, captures);
+    }
+
+    bool RouteTree::parse(std::string_view pattern, size_t parameterCount, std::vector<Segment>& segments) {
+        // Mounting at "/" is the same as mounting without a path
+        if (pattern.empty() || pattern == "/") {
+            return !parameterCount;
+        }
+
+        // Other trailing slashes change what the generated regexes accept
+        if (pattern.front() != '/' || pattern.back() == '/') {
+            return false;
+        }
+
+        size_t position = 0;
+
+        while (position < pattern.length()) {
+            auto end = pattern.find('/', position + 1);
+
+            if (end == std::string_view::npos) {
+                end = pattern.length();
+            }
+
+            auto text = pattern.substr(position + 1, end - position - 1);
+            position = end;
+
+            if (text.empty()) {
+                return false;
+            }
+
+            if (text.front() != ':') {
+                if (!isLiteral(text)) {
+                    return false;
+                }
+
+                segments.push_back(Segment{SegmentType::Literal, text});
+                continue;
+            }
+
+            auto name = text.substr(1);
+            auto type = SegmentType::Parameter;
+            constexpr std::string_view numeric = "(\\d+)";
+
+            if (name.length() > numeric.length() && name.substr(name.length() - numeric.length()) == numeric) {
+                name.remove_suffix(numeric.length());
+                type = SegmentType::NumericParameter;
+            }
+
+            if (!isParameterName(name)) {
+                return false;
+            }
+
+            segments.push_back(Segment{type, name});
+        }
+
+        size_t parameters = 0;
+
+        for (const auto& segment : segments) {
+            parameters += segment.type != SegmentType::Literal;
+        }
+
+        return parameters == parameterCount;
+    }
+
+    const RouteTree::Node* RouteTree::findLiteral(const Node& node, std::string_view segment) noexcept {
+        size_t low = 0, high = node.literals.size();
+
+        while (low < high) {
+            auto middle = (low + high) / 2;
+            auto comparison = compareLowercase(node.literals[middle].first, segment);
+
+            if (!comparison) {
+                return node.literals[middle].second.get();
+            }
+
+            if (comparison < 0) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void RouteTree::collect(
+        const Node& node,
+        std::string_view path,
+        size_t position,
+        std::vector<size_t>& positions,
+        std::vector<std::string_view>& stack,
+        std::vector<RouteMatch>& matches,
+        std::vector<std::string_view>& captures
+    ) const {
+        auto rest = path.substr(position);
+
+        auto addMatches = [&](const std::vector<RouteReference>& routes) {
+            for (const auto& [index, mountSegments] : routes) {
+                matches.push_back(RouteMatch{
+                    index,
+                    static_cast<uint32_t>(mountSegments ? positions[mountSegments - 1] : 0),
+                    static_cast<uint32_t>(position),
+                    static_cast<uint32_t>(captures.size()),
+                    static_cast<uint32_t>(stack.size()),
+                    false
+                });
+                captures.insert(captures.end(), stack.begin(), stack.end());
+            }
+        };
+
+        if (rest.empty() || rest.front() == '/') {
+            addMatches(node.partialRoutes);
+        }
+
+        if (rest.empty() || rest == "/") {
+            addMatches(node.wholeRoutes);
+        }
+
+        if (rest.empty() || rest.front() != '/') {
+            return;
+        }
+
+        auto end = path.find('/', position + 1);
+
+        if (end == std::string_view::npos) {
+            end = path.length();
+        }
+
+        auto segment = path.substr(position + 1, end - position - 1);
+
+        if (segment.empty()) {
+            return;
+        }
+
+        positions.push_back(end);
+
+        if (auto child = findLiteral(node, segment)) {
+            collect(*child, path, end, positions, stack, matches, captures);
+        }
+
+        if (node.numericParameter && isNumber(segment)) {
+            stack.push_back(segment);
+            collect(*node.numericParameter, path, end, positions, stack, matches, captures);
+            stack.pop_back();
+        }
+
+        if (node.parameter) {
+            stack.push_back(segment);
+            collect(*node.parameter, path, end, positions, stack, matches, captures);
+            stack.pop_back();
+        }
+
+        positions.pop_back();
+    }
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "commonHeaders.h"
+
+namespace nex {
+
+/**
+ * Candidate route for a path, `index` refers to the route's position in registration order.
+ * Captured parameter values are views into the matched path.
+ */
+struct RouteMatch {
+    size_t index;
+    // Length of the path consumed by the mount prefix of a flattened route
+    uint32_t mountLength;
+    uint32_t prefixLength;
+    uint32_t captureOffset;
+    uint32_t captureCount;
+    // Route could not be compiled into the tree and must still be checked with its regex
+    bool needsRegex;
+};
+
+/**
+ * Segment trie compiled from path-to-regexp patterns.
+ *
+ * Handles patterns made of literal segments and whole-segment named parameters, optionally
+ * typed as `(\d+)`. Literals compare case-insensitively, whole matches accept one trailing
+ * slash and partial matches end at a segment boundary, as the generated regexes do.
+ * Matching a path visits its segments once per branch, independent of the number of routes.
+ */
+class RouteTree {
+public:
+    /**
+     * Returns false when the pattern needs a regex and was not inserted.
+     * `mountSegments` is the number of leading segments that come from the mount path.
+     */
+    bool insert(
+        std::string_view pattern,
+        size_t parameterCount,
+        bool partial,
+        size_t index,
+        size_t mountSegments = 0
+    );
+
+    [[nodiscard]] static bool canCompile(std::string_view pattern, size_t parameterCount);
+
+    /**
+     * Appends every route matching the path, in no particular order
+     */
+    void match(
+        std::string_view path,
+        std::vector<RouteMatch>& matches,
+        std::vector<std::string_view>& captures
+    ) const;
+
+private:
+    enum class SegmentType : uint8_t {
+        Literal,
+        Parameter,
+        NumericParameter
+    };
+
+    struct Segment {
+        SegmentType type;
+        std::string_view text;
+    };
+
+    struct RouteReference {
+        size_t index;
+        size_t mountSegments;
+    };
+
+    struct Node {
+        // Sorted by lowercased literal
+        std::vector<std::pair<std::string, std::unique_ptr<Node>>> literals;
+        std::unique_ptr<Node> parameter{nullptr};
+        std::unique_ptr<Node> numericParameter{nullptr};
+        std::vector<RouteReference> wholeRoutes;
+        std::vector<RouteReference> partialRoutes;
+    };
+
+    static bool parse(std::string_view pattern, size_t parameterCount, std::vector<Segment>& segments);
+    static const Node* findLiteral(const Node& node, std::string_view segment) noexcept;
+
+    void collect(
+        const Node& node,
+        std::string_view path,
+        size_t position,
+        std::vector<size_t>& positions,
+        std::vector<std::string_view>& stack,
+        std::vector<RouteMatch>& matches,
+        std::vector<std::string_view>& captures
+    ) const;
+
+    Node root;
+};
+
+}
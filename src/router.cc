@@ -1,22 +1,145 @@
 #include "router.h"
+#include "jsStrings.h"
 
 namespace nex {
 
+    // RouteTable
+
+    void RouteTable::match(
+        std::string_view path,
+        std::vector<RouteMatch>& matches,
+        std::vector<std::string_view>& captures
+    ) const {
+        std::call_once(compiled, [this]() { compile(); });
+
+        tree.match(path, matches, captures);
+
+        regexRoutes.match(path, matches);
+
+        std::sort(matches.begin(), matches.end(), [](const RouteMatch& first, const RouteMatch& second) {
+            return first.index < second.index;
+        });
+    }
+
+    void RouteTable::prepare() const {
+        std::call_once(compiled, [this]() { compile(); });
+
+        regexRoutes.prepare();
+    }
+
+    void RouteTable::compile() const {
+        // Plain tables are a single frame, dispatch tables come with their frames
+        if (frames.empty()) {
+            auto size = static_cast<uint32_t>(entries.size());
+
+            frames.push_back(Frame{size, size, 0});
+            routes.resize(entries.size(), Route{0, size, 0, 0});
+
+            for (size_t i = 0; i < entries.size();) {
+                auto runEnd = i + 1;
+
+                while (runEnd < entries.size() && entries[runEnd].first == entries[i].first) {
+                    ++runEnd;
+                }
+
+                for (; i < runEnd; ++i) {
+                    routes[i].routeEnd = static_cast<uint32_t>(runEnd);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const auto& re = entries[i].first;
+            bool compiledIntoTree = re.getPattern().length() || re.isPartial()
+                ? tree.insert(
+                    re.getPattern(),
+                    re.getParameterNames().size(),
+                    re.isPartial(),
+                    i,
+                    routes[i].mountSegments
+                )
+                : false;
+
+            if (!compiledIntoTree) {
+                regexRoutes.insert(re, i);
+            }
+        }
+    }
+
+    namespace {
+
+        std::string_view normalizeMountPattern(const std::string& pattern) {
+            return pattern == "/" ? std::string_view() : std::string_view(pattern);
+        }
+
+        bool isComposable(const PathRegExp& re) {
+            return (re.isPartial() || re.getPattern().length())
+                && RouteTree::canCompile(re.getPattern(), re.getParameterNames().size());
+        }
+
+        bool isComposable(const RouteTable& table) {
+            return std::all_of(table.entries.begin(), table.entries.end(), [](const MiddlewareConfig& entry) {
+                return isComposable(entry.first);
+            });
+        }
+
+        PathRegExp composeRoute(const PathRegExp& mount, const PathRegExp& route) {
+            auto mountPattern = normalizeMountPattern(mount.getPattern());
+            auto routePattern = normalizeMountPattern(route.getPattern());
+
+            std::string pattern(mountPattern);
+            pattern += routePattern;
+
+            if (pattern.empty() && !route.isPartial()) {
+                pattern = "/";
+            }
+
+            std::string regex;
+
+            if (mountPattern.empty()) {
+                regex = route.getRegexString();
+            } else if (routePattern.empty()) {
+                regex = mount.getRegexString();
+            } else {
+                regex = mount.getRegexString() + route.getRegexString();
+            }
+
+            auto parameterNames = mount.getParameterNames();
+            const auto& routeParameterNames = route.getParameterNames();
+
+            parameterNames.insert(parameterNames.end(), routeParameterNames.begin(), routeParameterNames.end());
+
+            return PathRegExp(std::move(regex), std::move(parameterNames), route.isPartial(), std::move(pattern));
+        }
+
+    }
+
     // Router
 
     Router::Router(v8::Isolate* isolate)
-        : isolate(isolate) {}
+        : isolate(isolate)
+    {
+        for (auto& slot : methodToConfigs) {
+            slot = std::make_shared<RouteTable>();
+        }
+    }
 
-    void Router::process(std::shared_ptr<Request> req, std::shared_ptr<Response> res) {
-        auto method = req->getHttpMethod();
-        if (!methodToConfigs[method]) {
-            methodToConfigs[method] = std::make_shared<std::vector<MiddlewareConfig>>();
+    Router::~Router() {
+        for (const auto& slot : methodToConfigs) {
+            for (const auto& [re, middleware] : slot->entries) {
+                if (auto nested = dynamic_cast<Router*>(middleware.get())) {
+                    auto& nestedParents = nested->parents;
+
+                    nestedParents.erase(std::remove(nestedParents.begin(), nestedParents.end(), this), nestedParents.end());
+                }
+            }
         }
+    }
 
-        auto middlewareList = methodToConfigs[method];
-        auto pipeline = new Pipeline(std::move(req), std::move(res), middlewareList, isolate);
+    void Router::process(std::shared_ptr<Request> req, std::shared_ptr<Response> res) {
+        auto routeTable = getDispatchTable(req->getHttpMethod());
 
-        pipeline->execute();
+        Pipeline::start(std::move(req), std::move(res), std::move(routeTable), isolate);
     }
 
     void Router::use(
@@ -24,9 +147,15 @@ namespace nex {
         bool canHandlePartial,
         const std::vector<std::string>& paramKeys,
         const std::string& path,
+        const std::string& pattern,
         const std::shared_ptr<AbstractMiddleware>& middleware
     ) {
-        auto re = PathRegExp(path, paramKeys, canHandlePartial);
+        auto re = PathRegExp(path, paramKeys, canHandlePartial, pattern);
+
+        // Routes added before listen() are checked by freeze()
+        if (frozen.load(std::memory_order_acquire)) {
+            re.prepare();
+        }
 
         if (method == HttpMethod::ALL) {
             for (const auto m : ALL_HTTP_METHODS) {
@@ -38,6 +167,121 @@ namespace nex {
         if (middleware->isErrorHandling()) {
             errorHandling = true;
         }
+
+        if (auto nested = dynamic_cast<Router*>(middleware.get())) {
+            auto& nestedParents = nested->parents;
+
+            if (std::find(nestedParents.begin(), nestedParents.end(), this) == nestedParents.end()) {
+                nestedParents.push_back(this);
+            }
+
+            // A router mounted after listen() is routed through right away
+            if (frozen.load(std::memory_order_acquire)) {
+                nested->freeze();
+            }
+        }
+
+        touch();
+    }
+
+    void Router::touch(size_t depth) {
+        routesGeneration.fetch_add(1, std::memory_order_release);
+
+        // Also what stops cycles of nested routers
+        if (depth >= maxFlattenDepth) {
+            return;
+        }
+
+        for (auto parent : parents) {
+            parent->touch(depth + 1);
+        }
+    }
+
+    void Router::freeze() const {
+        // Also what stops cycles of nested routers
+        if (frozen.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+
+        try {
+            for (const auto& slot : methodToConfigs) {
+                for (const auto& [re, middleware] : slot->entries) {
+                    if (auto nested = dynamic_cast<const Router*>(middleware.get())) {
+                        nested->freeze();
+                    }
+                }
+            }
+
+            // Bad patterns fail here rather than on the first request that reaches them
+            for (const auto m : ALL_HTTP_METHODS) {
+                getDispatchTable(m)->prepare();
+            }
+        } catch (...) {
+            frozen.store(false, std::memory_order_release);
+            throw;
+        }
+    }
+
+    bool Router::requiresIsolate(HttpMethod method, const std::string& path, RouteCache& routeCache) const {
+        return routesRequireIsolate(method, path, routeCache.isEnabled() ? &routeCache : nullptr);
+    }
+
+    bool Router::requiresIsolate(HttpMethod method, const std::string& path) const {
+        return routesRequireIsolate(method, path, nullptr);
+    }
+
+    bool Router::routesRequireIsolate(HttpMethod method, const std::string& path, RouteCache* routeCache) const {
+        auto routeTable = getDispatchTable(method);
+
+        // Native-only routes need no match at all
+        if (!routeTable->mayRequireIsolate) {
+            return false;
+        }
+
+        std::vector<RouteMatch> matched;
+        std::vector<std::string_view> captures;
+        const std::vector<RouteMatch>* matches = &matched;
+
+        if (!routeCache) {
+            routeTable->match(path, matched, captures);
+        } else if (auto entry = routeCache->find(method, path, routeTable.get())) {
+            matches = &entry->matches;
+        } else {
+            routeTable->match(path, matched, captures);
+            routeCache->insert(method, path, routeTable, matched, captures);
+        }
+
+        RouteParamMapping params;
+        std::string basePath, restPath;
+
+        for (const auto& match : *matches) {
+            const auto& route = routeTable->routes[match.index];
+
+            if (route.isolateUse == RouteTable::IsolateUse::Never) {
+                continue;
+            }
+
+            const auto& [re, middleware] = routeTable->entries[match.index];
+            restPath = path;
+
+            if (match.needsRegex) {
+                if (!re.match(path, params, basePath, restPath)) {
+                    continue;
+                }
+            } else if (re.isPartial() || route.mountSegments) {
+                restPath = path.substr(re.isPartial() ? match.prefixLength : match.mountLength);
+
+                if (restPath.empty()) {
+                    restPath = "/";
+                }
+            }
+
+            if (route.isolateUse == RouteTable::IsolateUse::Always || middleware->requiresIsolate(method, restPath)) {
+                return true;
+            }
+        }
+
+        return false;
     }
 
     void Router::fillConfig(
@@ -45,10 +289,144 @@ namespace nex {
         const PathRegExp& re,
         std::shared_ptr<AbstractMiddleware> middleware
     ) {
-        if (!methodToConfigs[method]) {
-            methodToConfigs[method] = std::make_shared<std::vector<MiddlewareConfig>>();
+        auto index = getMethodIndex(method);
+
+        if (index >= HTTP_METHODS_COUNT) {
+            return;
+        }
+
+        auto& slot = methodToConfigs[index];
+
+        // Copying the table for every registered route would make startup quadratic
+        if (!frozen.load(std::memory_order_acquire)) {
+            slot->entries.emplace_back(re, std::move(middleware));
+            return;
+        }
+
+        auto routeTable = std::make_shared<RouteTable>(*std::atomic_load(&slot));
+
+        routeTable->entries.emplace_back(re, std::move(middleware));
+        std::atomic_store(&slot, std::move(routeTable));
+    }
+
+    std::shared_ptr<const RouteTable> Router::getConfigs(HttpMethod method) const {
+        auto index = getMethodIndex(method);
+
+        if (index >= HTTP_METHODS_COUNT) {
+            return std::make_shared<const RouteTable>();
+        }
+
+        return std::atomic_load(&methodToConfigs[index]);
+    }
+
+    std::shared_ptr<const RouteTable> Router::getDispatchTable(HttpMethod method) const {
+        auto index = getMethodIndex(method);
+
+        if (index >= HTTP_METHODS_COUNT) {
+            return std::make_shared<const RouteTable>();
+        }
+
+        // Read first, so that a use() racing with the rebuild leaves the table stale
+        auto generation = routesGeneration.load(std::memory_order_acquire);
+        auto& slot = dispatchTables[index];
+        auto table = std::atomic_load(&slot);
+
+        if (table && table->generation == generation) {
+            return table;
+        }
+
+        auto dispatchTable = std::make_shared<RouteTable>();
+
+        dispatchTable->generation = generation;
+        dispatchTable->frames.push_back(RouteTable::Frame{0, 0, 0});
+        flatten(*getConfigs(method), method, nullptr, 0, 0, *dispatchTable);
+
+        auto size = static_cast<uint32_t>(dispatchTable->entries.size());
+        dispatchTable->frames[0].end = dispatchTable->frames[0].runEnd = size;
+        dispatchTable->mayRequireIsolate = std::any_of(
+            dispatchTable->routes.begin(),
+            dispatchTable->routes.end(),
+            [](const RouteTable::Route& route) { return route.isolateUse != RouteTable::IsolateUse::Never; }
+        );
+
+        table = std::move(dispatchTable);
+        std::atomic_store(&slot, table);
+
+        return table;
+    }
+
+    void Router::flatten(
+        const RouteTable& source,
+        HttpMethod method,
+        const PathRegExp* mount,
+        uint32_t frame,
+        size_t depth,
+        RouteTable& table
+    ) const {
+        const auto& entries = source.entries;
+        uint32_t mountSegments = 0, mountParameters = 0;
+
+        if (mount) {
+            auto mountPattern = normalizeMountPattern(mount->getPattern());
+
+            mountSegments = static_cast<uint32_t>(std::count(mountPattern.begin(), mountPattern.end(), '/'));
+            mountParameters = static_cast<uint32_t>(mount->getParameterNames().size());
+        }
+
+        // Flattened position of every entry, and the frame of the nested routers that were inlined
+        std::vector<uint32_t> starts(entries.size() + 1);
+        std::vector<uint32_t> nestedFrames(entries.size(), 0);
+
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const auto& [re, middleware] = entries[i];
+            auto route = mount ? composeRoute(*mount, re) : re;
+            auto nested = dynamic_cast<const Router*>(middleware.get());
+
+            starts[i] = static_cast<uint32_t>(table.entries.size());
+
+            if (nested && route.isPartial() && depth < maxFlattenDepth && isComposable(route)) {
+                auto nestedSource = nested->getConfigs(method);
+
+                if (isComposable(*nestedSource)) {
+                    auto nestedFrame = static_cast<uint32_t>(table.frames.size());
+
+                    nestedFrames[i] = nestedFrame;
+                    table.frames.push_back(RouteTable::Frame{0, 0, frame});
+                    nested->flatten(*nestedSource, method, &route, nestedFrame, depth + 1, table);
+                    table.frames[nestedFrame].end = static_cast<uint32_t>(table.entries.size());
+
+                    continue;
+                }
+            }
+
+            // Middlewares other than routers answer regardless of the path
+            auto isolateUse = nested
+                ? RouteTable::IsolateUse::Nested
+                : middleware->requiresIsolate(method, route.getPattern())
+                    ? RouteTable::IsolateUse::Always
+                    : RouteTable::IsolateUse::Never;
+
+            table.entries.emplace_back(std::move(route), middleware);
+            table.routes.push_back(RouteTable::Route{frame, 0, mountSegments, mountParameters, isolateUse});
+        }
+
+        starts[entries.size()] = static_cast<uint32_t>(table.entries.size());
+
+        for (size_t i = 0; i < entries.size();) {
+            auto runEnd = i + 1;
+
+            while (runEnd < entries.size() && entries[runEnd].first == entries[i].first) {
+                ++runEnd;
+            }
+
+            for (; i < runEnd; ++i) {
+                if (nestedFrames[i]) {
+                    table.frames[nestedFrames[i]].runEnd = starts[runEnd];
+                } else {
+                    table.routes[starts[i]].routeEnd = starts[runEnd];
+                }
+            }
         }
-        methodToConfigs[method]->push_back(std::make_pair(re, std::move(middleware)));
     }
 
     void Router::emit(
@@ -56,197 +434,366 @@ namespace nex {
         std::shared_ptr<Response> res,
         NextObject& next
     ) {
-        auto middlewareList = methodToConfigs[req->getHttpMethod()];
-        auto pipeline = new Pipeline(
-            std::move(req),
-            std::move(res),
-            middlewareList,
-            &next,
-            isolate
-        );
+        auto routeTable = getDispatchTable(req->getHttpMethod());
+        auto pipeline = next.getPipeline();
+
+        if (!pipeline) {
+            Pipeline::start(std::move(req), std::move(res), std::move(routeTable), isolate);
+            return;
+        }
 
-        pipeline->execute();
+        pipeline->branch(std::move(routeTable));
     }
 
-    // Pipeline
+    // PipelinePool
 
-    Pipeline::Pipeline(
-        std::shared_ptr<Request> request,
-        std::shared_ptr<Response> response,
-        std::shared_ptr<std::vector<MiddlewareConfig>> middlewareList,
-        v8::Isolate* isolate
-    ): req(std::move(request)),
-        res(std::move(response)),
-        middlewareList(std::move(middlewareList)),
-        isBase(true),
-        isolate(isolate)
-    {
-        setNextObject();
+    PipelinePool::~PipelinePool() {
+        for (auto pipeline : pipelines) {
+            delete pipeline;
+        }
+    }
+
+    Pipeline* PipelinePool::acquire(v8::Isolate* isolate) {
+        if (pipelines.empty()) {
+            return new Pipeline(isolate);
+        }
+
+        auto pipeline = pipelines.back();
+
+        pipelines.pop_back();
+
+        return pipeline;
+    }
+
+    void PipelinePool::release(Pipeline* pipeline) noexcept {
+        if (pipelines.size() >= maxPooled) {
+            delete pipeline;
+            return;
+        }
+
+        try {
+            pipelines.push_back(pipeline);
+        } catch (const std::exception&) {
+            delete pipeline;
+        }
     }
 
-    Pipeline::Pipeline(
+    // Pipeline
+
+    Pipeline::Pipeline(v8::Isolate* isolate)
+        : nextObject(this, isolate),
+          endCallback([this]() { release(); })
+    {}
+
+    void Pipeline::start(
         std::shared_ptr<Request> request,
         std::shared_ptr<Response> response,
-        std::shared_ptr<std::vector<MiddlewareConfig>> middlewareList,
-        NextObject* baseNextObj,
+        std::shared_ptr<const RouteTable> routeTable,
         v8::Isolate* isolate
-    ): req(std::move(request)),
-       res(std::move(response)),
-       baseNext(baseNextObj),
-       middlewareList(std::move(middlewareList)),
-       isBase(false),
-       isolate(isolate)
-    {
-        setNextObject();
+    ) {
+        auto context = response->httpConnection->context;
+        auto pipeline = context->getPipelinePool().acquire(isolate);
+
+        pipeline->nextObject.isolate = isolate;
+        pipeline->req = std::move(request);
+        pipeline->res = std::move(response);
+        pipeline->context = std::move(context);
+        pipeline->isHandled = false;
+        pipeline->res->pipelineEndCallback = &pipeline->endCallback;
+
+        pipeline->enter(std::move(routeTable), pipeline->req->pathWithoutQueryString);
+        pipeline->next();
     }
 
+    void Pipeline::enter(std::shared_ptr<const RouteTable> routeTable, const std::string& path) {
+        if (depth == levels.size()) {
+            levels.emplace_back();
+        }
 
-    void Pipeline::setNextObject() {
-        std::function<void()> nextFunc = [this]() {
-            if (!isValid()) {
-                res->end();
-                return;
-            }
-            auto nextMiddleware = getNext();
+        auto& level = levels[depth++];
 
-            if (!nextMiddleware) {
-                if (!isBase) {
-                    res->pipelineEndCallback = baseEliminateCallback;
-                    baseNext->next();
+        level.routeTable = std::move(routeTable);
+        level.matchPath = path;
+        level.current = 0;
+        level.lastEmitted = SIZE_MAX;
 
-                    eliminate();
-                } else {
-                    if (res->areHeadersSent()) {
-                        res->end();
-                    }
-                    else {
-                        res->setStatus(404);
-                        res->end();
-                    }
-                }
+        auto& routeCache = context->getRouteCache();
 
-                return;
-            }
-            if (!isHandled) {
-                isHandled = true;
-                res->setStatus(200);
-            }
+        if (depth > 1 || !routeCache.isEnabled()) {
+            level.routeTable->match(level.matchPath, level.matches, level.captures);
+            return;
+        }
 
-            req->error.clear();
-            nextMiddleware->emit(req, res, next);
-        };
+        auto method = req->getHttpMethod();
 
-        std::function<void()> nextRoute = [this]() {
-            if (!isValid()) {
-                res->end();
-                return;
+        if (auto entry = routeCache.find(method, level.matchPath, level.routeTable.get())) {
+            level.matches = entry->matches;
+
+            for (const auto& [offset, length] : entry->captures) {
+                level.captures.emplace_back(level.matchPath.data() + offset, length);
             }
 
-            auto nextMiddleware = getNext(true);
+            return;
+        }
 
-            if (!nextMiddleware) {
-                if (!isBase) {
-                    res->pipelineEndCallback = baseEliminateCallback;
-                    baseNext->nextRoute();
-                    eliminate();
-                } else {
-                    if (res->areHeadersSent())
-                        res->end();
-                    else {
-                        res->setStatus(404);
-                        res->end();
-                    }
-                }
+        level.routeTable->match(level.matchPath, level.matches, level.captures);
+        routeCache.insert(method, level.matchPath, level.routeTable, level.matches, level.captures);
+    }
 
-                return;
-            }
+    void Pipeline::branch(std::shared_ptr<const RouteTable> routeTable) {
+        enter(std::move(routeTable), req->relativePath);
 
-            req->error.clear();
-            nextMiddleware->emit(req, res, next);
-        };
+        // Routers reached while handling an error only run their error handlers
+        if (req->error.empty()) {
+            next();
+        } else {
+            auto err = req->error;
 
-        std::function<void(const std::string&)> error = [this](const std::string& err) {
-            if (!isValid()) {
-                res->end();
-                return;
-            }
+            error(err);
+        }
+    }
 
-            req->onDataCallback = nullptr;
-            req->onDataEndCallback = nullptr;
-            req->error = err;
+    void Pipeline::leave() {
+        auto& level = levels[--depth];
 
-            auto nextMiddleware = getNextErrorHandling();
+        level.routeTable.reset();
+        level.matches.clear();
+        level.captures.clear();
+    }
 
-            if (!nextMiddleware) {
-                if (!isBase) {
-                    res->pipelineEndCallback = baseEliminateCallback;
-                    baseNext->next();
-                    eliminate();
-                } else {
-                    if (res->areHeadersSent())
-                        res->end();
-                    else {
-                        res->setStatus(500);
-                        res->end();
-                    }
-                }
+    void Pipeline::release() {
+        nextObject.invalidate();
 
-                return;
+        while (depth) {
+            leave();
+        }
+
+        req.reset();
+        res.reset();
+
+        // The pool may be the last thing keeping the loop context alive
+        auto owner = std::move(context);
+
+        owner->getPipelinePool().release(this);
+    }
+
+    void Pipeline::next() {
+        if (!res) {
+            return;
+        }
+
+        if (!isValid()) {
+            auto response = res;
+
+            response->end();
+            return;
+        }
+
+        auto nextMiddleware = getNext();
+
+        if (!nextMiddleware) {
+            finish(404);
+            return;
+        }
+
+        if (!isHandled) {
+            isHandled = true;
+            res->setStatus(200);
+        }
+
+        req->error.clear();
+        emit(nextMiddleware);
+    }
+
+    void Pipeline::nextRoute() {
+        if (!res) {
+            return;
+        }
+
+        if (!isValid()) {
+            auto response = res;
+
+            response->end();
+            return;
+        }
+
+        auto nextMiddleware = getNext(true);
+
+        if (!nextMiddleware) {
+            finish(404);
+            return;
+        }
+
+        req->error.clear();
+        emit(nextMiddleware);
+    }
+
+    void Pipeline::error(const std::string& err) {
+        if (!res) {
+            return;
+        }
+
+        if (!isValid()) {
+            auto response = res;
+
+            response->end();
+            return;
+        }
+
+        req->onDataCallback = nullptr;
+        req->onDataEndCallback = nullptr;
+        req->error = err;
+
+        auto nextMiddleware = getNextErrorHandling();
+
+        if (!nextMiddleware) {
+            finish(500);
+            return;
+        }
+
+        nextMiddleware->emit(req, res, nextObject);
+    }
+
+    void Pipeline::emit(const std::shared_ptr<AbstractMiddleware>& middleware) {
+        auto plain = dynamic_cast<PlainMiddleware*>(middleware.get());
+
+        if (!plain || !plain->isChainable()) {
+            middleware->emit(req, res, nextObject);
+            return;
+        }
+
+        // Following handlers of the same route go to JS together with this one
+        auto& level = levels[depth - 1];
+        const auto& routeTable = *level.routeTable;
+        const auto& emitted = routeTable.entries[level.lastEmitted];
+        auto frame = routeTable.routes[level.lastEmitted].frame;
+
+        chain.clear();
+        chain.push_back(plain);
+
+        while (level.current < level.matches.size()) {
+            auto index = level.matches[level.current].index;
+
+            if (
+                index != level.lastEmitted + 1
+                || routeTable.routes[index].frame != frame
+                || routeTable.entries[index].first != emitted.first
+            ) {
+                break;
             }
 
-            nextMiddleware->emit(req, res, next);
-        };
+            auto following = dynamic_cast<PlainMiddleware*>(routeTable.entries[index].second.get());
 
-        eliminateCallback = [this]() {
-            if (baseEliminateCallback) {
-                (*baseEliminateCallback)();
+            if (!following || !following->isChainable()) {
+                break;
             }
 
-            eliminate();
-        };
+            chain.push_back(following);
+            level.lastEmitted = index;
+            ++level.current;
+        }
 
-        baseEliminateCallback = res->pipelineEndCallback;
-        res->pipelineEndCallback = &eliminateCallback;
+        if (chain.size() == 1) {
+            middleware->emit(req, res, nextObject);
+            return;
+        }
 
-        next = NextObject(nextFunc, nextRoute, error, isolate);
+        PlainMiddleware::emitChain(chain, req, res, nextObject);
     }
 
-    void Pipeline::execute() {
-        next();
-    }
+    void Pipeline::finish(uint32_t status) {
+        // Ending the response releases the pipeline
+        auto response = res;
+
+        if (!response->areHeadersSent()) {
+            response->setStatus(status);
+        }
 
-    void Pipeline::eliminate() {
-        delete this;
+        response->end();
     }
 
     std::shared_ptr<AbstractMiddleware> Pipeline::getNext(bool passCurrentMiddlewares) {
-        bool changed = false;
-
-        for(; current < middlewareList->size(); ++current) {
-            auto& re = (*middlewareList)[current].first;
+        // A nested router that runs out of routes continues its parent, as next() or next('route')
+        for (;; leave()) {
+            auto& level = levels[depth - 1];
+            const auto& routeTable = *level.routeTable;
+            bool found = false;
+
+            // next('route') skips the rest of the routes sharing the path of the current one,
+            // leaving an inlined router the same way as it skips the router's own mount
+            if (passCurrentMiddlewares && level.lastEmitted != SIZE_MAX) {
+                const auto& route = routeTable.routes[level.lastEmitted];
+                size_t position = route.routeEnd;
+                auto frame = route.frame;
+
+                while (!found) {
+                    const auto& routeFrame = routeTable.frames[frame];
+
+                    while (level.current < level.matches.size() && level.matches[level.current].index < position) {
+                        ++level.current;
+                    }
 
-            if (!changed && passCurrentMiddlewares && current > 0) {
-                auto& previousRe = (*middlewareList)[current - 1].first;
+                    if (!frame) {
+                        break;
+                    }
 
-                if (re == previousRe) {
-                    continue;
+                    found = findMatch(level, routeFrame.end);
+                    position = routeFrame.runEnd;
+                    frame = routeFrame.parent;
                 }
             }
 
-            changed = true;
+            if (found || findMatch(level, routeTable.entries.size())) {
+                level.lastEmitted = level.matches[level.current++].index;
 
-            auto& path = isBase ? req->pathWithoutQueryString : req->relativePath;
+                return routeTable.entries[level.lastEmitted].second;
+            }
 
-            if (re.match(path, req->routeParams, req->basePath, req->relativePath)) {
-                break;
+            if (depth == 1) {
+                return std::shared_ptr<AbstractMiddleware>{nullptr};
             }
         }
+    }
 
-        if (current >= middlewareList->size()) {
-            return std::shared_ptr<AbstractMiddleware>{nullptr};
+    bool Pipeline::findMatch(Level& level, size_t end) {
+        for (; level.current < level.matches.size() && level.matches[level.current].index < end; ++level.current) {
+            if (apply(level, level.matches[level.current])) {
+                return true;
+            }
         }
 
-        return (*middlewareList)[current++].second;
+        return false;
+    }
+
+    bool Pipeline::apply(Level& level, const RouteMatch& match) {
+        const auto& re = level.routeTable->entries[match.index].first;
+        const auto& route = level.routeTable->routes[match.index];
+        const auto& matchPath = level.matchPath;
+
+        if (match.needsRegex) {
+            return re.match(matchPath, req->routeParams, req->basePath, req->relativePath);
+        }
+
+        const auto& parameterNames = re.getParameterNames();
+
+        req->routeParams.clear();
+
+        // Inlined routes only see their own parameters, as they would behind the mount
+        for (size_t i = route.mountParameters; i < match.captureCount && i < parameterNames.size(); ++i) {
+            req->routeParams[parameterNames[i]] = std::string(level.captures[match.captureOffset + i]);
+        }
+
+        req->basePath.assign(matchPath, match.mountLength, match.prefixLength - match.mountLength);
+
+        if (re.isPartial() || route.mountSegments) {
+            req->relativePath.assign(matchPath, re.isPartial() ? match.prefixLength : match.mountLength);
+
+            if (req->relativePath.empty()) {
+                req->relativePath = "/";
+            }
+        }
+
+        return true;
     }
 
     std::shared_ptr<AbstractMiddleware> Pipeline::getNextErrorHandling() {
@@ -270,17 +817,17 @@ namespace nex {
         v8::Isolate* isolate = args.GetIsolate();
         auto wrapInstance = ObjectWrap::Unwrap<RouterMethods>(args.Holder());
 
-        if (!wrapInstance || !wrapInstance->routerInstance || args.Length() < 5) {
+        if (!wrapInstance || !wrapInstance->routerInstance || args.Length() < 6) {
             return;
         }
         auto instance = wrapInstance->routerInstance;
 
         HttpMethod method;
         bool canHandlePartial;
-        std::string path;
+        std::string path, pattern;
         std::vector<std::string> pathParamKeys;
 
-        for (int i = 0; i < 5; ++i) {
+        for (int i = 0; i < 6; ++i) {
             if (args[i].IsEmpty()) {
                 return;
             }
@@ -342,10 +889,30 @@ namespace nex {
             return;
         }
 
-        auto errorHandlingKey = v8::String::NewFromUtf8(isolate, "isErrorHandling",
-            v8::NewStringType::kInternalized).ToLocalChecked();
+        // Source path pattern, lets plain routes skip the regex
+        if (args[4]->IsString()) {
+            v8::String::Utf8Value internalVal(isolate, args[4]);
+            pattern = *internalVal;
+        } else if (!args[4]->IsNull()) {
+            return;
+        }
 
-        for (int i = 4; i < args.Length(); ++i) {
+        // Mounting on a router that is already listening compiles the patterns right away
+        auto useMiddleware = [&](std::shared_ptr<AbstractMiddleware> middleware) {
+            try {
+                instance->use(method, canHandlePartial, pathParamKeys, path, pattern, middleware);
+                return true;
+            } catch (const std::regex_error& e) {
+                isolate->ThrowException(v8::Exception::SyntaxError(v8::String::NewFromUtf8(
+                        isolate, (std::string("Invalid route pattern: ") + e.what()).c_str(),
+                        v8::NewStringType::kNormal).ToLocalChecked()));
+                return false;
+            }
+        };
+
+        auto errorHandlingKey = JsStrings::get(isolate, JsKey::IsErrorHandling);
+
+        for (int i = 5; i < args.Length(); ++i) {
             if (args[i].IsEmpty() || (!args[i]->IsObject() && !args[i]->IsFunction())) {
                 continue;
             }
@@ -364,13 +931,14 @@ namespace nex {
                         new PlainMiddleware(plainMwValue, isErrorHandling, isolate)
                 );
 
-                instance->use(method, canHandlePartial, pathParamKeys, path, plainMiddlewareInstance);
+                if (!useMiddleware(plainMiddlewareInstance)) {
+                    return;
+                }
                 continue;
             }
 
             if (args[i]->IsObject()) {
-                auto nativeMiddlewareFlag = v8::String::NewFromUtf8(isolate, "__isNexpressNativeMiddleware",
-                    v8::NewStringType::kInternalized).ToLocalChecked();
+                auto nativeMiddlewareFlag = JsStrings::get(isolate, JsKey::IsNexpressNativeMiddleware);
                 auto middlewareObject = args[i].As<v8::Object>();
 
                 if (middlewareObject.IsEmpty()) {
@@ -382,22 +950,15 @@ namespace nex {
                 if (!nativeFlag.IsEmpty() && nativeFlag->IsBoolean() && nativeFlag.As<v8::Boolean>()->Value()) {
                     auto nativeWrapInstance = ObjectWrap::Unwrap<NativeLoadedMiddlewareWrapper>(middlewareObject);
 
-                    instance->use(
-                        method,
-                        canHandlePartial,
-                        pathParamKeys,
-                        path,
-                        nativeWrapInstance->getInstance()
-                    );
+                    if (!useMiddleware(nativeWrapInstance->getInstance())) {
+                        return;
+                    }
                     continue;
                 }
 
-                auto internalInstanceKey = v8::String::NewFromUtf8(isolate, "__instance",
-                    v8::NewStringType::kInternalized).ToLocalChecked();
-                auto appFlag = v8::String::NewFromUtf8(isolate, "__isNexpressApp",
-                    v8::NewStringType::kInternalized).ToLocalChecked();
-                auto routerFlag = v8::String::NewFromUtf8(isolate, "__isNexpressRouter",
-                    v8::NewStringType::kInternalized).ToLocalChecked();
+                auto internalInstanceKey = JsStrings::get(isolate, JsKey::Instance);
+                auto appFlag = JsStrings::get(isolate, JsKey::IsNexpressApp);
+                auto routerFlag = JsStrings::get(isolate, JsKey::IsNexpressRouter);
 
                 auto internalInstance = middlewareObject->Get(internalInstanceKey);
 
@@ -424,7 +985,9 @@ namespace nex {
                     auto routerInstance = routerMethodsInstance->routerInstance;
 
                     if (routerInstance) {
-                        instance->use(method, canHandlePartial, pathParamKeys, path, routerInstance);
+                        if (!useMiddleware(routerInstance)) {
+                            return;
+                        }
                         continue;
                     }
                 }
@@ -11,10 +11,81 @@
 #include "request.h"
 #include "response.h"
 #include "pathRegexp.h"
+#include "regexRouteIndex.h"
+#include "routeTree.h"
 
 namespace nex {
 typedef std::pair<PathRegExp, std::shared_ptr<AbstractMiddleware>> MiddlewareConfig;
 
+/**
+ * Middlewares registered for one method, in registration order.
+ * Immutable once published, the route tree is compiled on the first match.
+ *
+ * Dispatch tables built by Router::freeze also inline the middlewares of nested routers,
+ * with mount paths composed into the patterns; frames keep the nesting for next('route').
+ */
+class RouteTable {
+public:
+    RouteTable() = default;
+    RouteTable(const RouteTable& other) : entries(other.entries) {}
+
+    /**
+     * Collects the routes matching the path, sorted by registration order
+     */
+    void match(
+        std::string_view path,
+        std::vector<RouteMatch>& matches,
+        std::vector<std::string_view>& captures
+    ) const;
+
+    /**
+     * Compiles the route tree and the regexes of routes it can't take,
+     * throws std::regex_error for a bad pattern
+     */
+    void prepare() const;
+
+    std::vector<MiddlewareConfig> entries;
+
+private:
+    friend class Router;
+    friend class Pipeline;
+
+    enum class IsolateUse : uint8_t {
+        Never,
+        Always,
+        // A router that wasn't inlined, depends on the routes it matches
+        Nested
+    };
+
+    struct Route {
+        uint32_t frame;
+        // End of the run of routes sharing this route's path within its frame
+        uint32_t routeEnd;
+        uint32_t mountSegments;
+        uint32_t mountParameters;
+        IsolateUse isolateUse = IsolateUse::Always;
+    };
+
+    struct Frame {
+        uint32_t end;
+        // Where the parent frame resumes after next('route') leaves this frame
+        uint32_t runEnd;
+        uint32_t parent;
+    };
+
+    void compile() const;
+
+    mutable std::once_flag compiled;
+    mutable RouteTree tree;
+    // Routes with custom patterns, matched with their regexes
+    mutable RegexRouteIndex regexRoutes;
+    mutable std::vector<Route> routes;
+    mutable std::vector<Frame> frames;
+    uint64_t generation = 0;
+    // Set for dispatch tables when they are built, false when no route can call into JS
+    bool mayRequireIsolate = true;
+};
+
 using v8::Persistent;
 using v8::Local;
 using v8::Isolate;
@@ -32,12 +103,22 @@ public:
     explicit Router(v8::Isolate* isolate);
 
     void process(std::shared_ptr<Request> req, std::shared_ptr<Response> res) final;
+    bool requiresIsolate(HttpMethod method, const std::string& path, RouteCache& routeCache) const final;
+    bool requiresIsolate(HttpMethod method, const std::string& path) const final;
+
+    /**
+     * Builds the dispatch tables of every method ahead of the first request, nested routers are
+     * frozen along. Tables are rebuilt on demand once it or a router nested in it gets new middlewares.
+     * Throws std::regex_error when a route pattern doesn't compile.
+     */
+    void freeze() const;
 
     void use(
         HttpMethod method,
         bool canHandlePartial,
         const std::vector<std::string>& paramKeys,
         const std::string& path,
+        const std::string& pattern,
         const std::shared_ptr<AbstractMiddleware>& middleware
     );
 
@@ -47,59 +128,111 @@ public:
         NextObject& next
     ) final;
 
-    virtual ~Router() = default;
+    virtual ~Router();
 
 private:
 
+    // Nested routers deeper than this stay separate pipelines, which also stops cycles
+    static constexpr size_t maxFlattenDepth = 16;
+
     void fillConfig(HttpMethod method, const PathRegExp& re, std::shared_ptr<AbstractMiddleware> middleware);
+    [[nodiscard]] std::shared_ptr<const RouteTable> getConfigs(HttpMethod method) const;
+    [[nodiscard]] std::shared_ptr<const RouteTable> getDispatchTable(HttpMethod method) const;
 
-    std::map<HttpMethod, std::shared_ptr<std::vector<MiddlewareConfig>>> methodToConfigs;
+    /**
+     * Top-level matches go through the route cache when one is given, the pipeline finds them there
+     */
+    [[nodiscard]] bool routesRequireIsolate(HttpMethod method, const std::string& path, RouteCache* routeCache) const;
+
+    void flatten(
+        const RouteTable& source,
+        HttpMethod method,
+        const PathRegExp* mount,
+        uint32_t frame,
+        size_t depth,
+        RouteTable& table
+    ) const;
+
+    /**
+     * Marks the dispatch tables of this router and of the routers it is mounted in as stale
+     */
+    void touch(size_t depth = 0);
+
+    // Bumped by use() on this router or on a router nested in it
+    std::atomic<uint64_t> routesGeneration{0};
+    // Routers this one is mounted in, their dispatch tables inline its routes
+    std::vector<Router*> parents;
+
+    // Tables are copied on write once frozen, so that I/O threads may route while JS adds middlewares
+    std::array<std::shared_ptr<RouteTable>, HTTP_METHODS_COUNT> methodToConfigs;
+    // Nothing routes before freeze(), until then middlewares are appended in place
+    mutable std::atomic<bool> frozen{false};
+    mutable std::array<std::shared_ptr<const RouteTable>, HTTP_METHODS_COUNT> dispatchTables;
 
     v8::Isolate* isolate;
 };
 
 
+/**
+ * Routing state of one request. Pipelines come from the pool of the serving loop and
+ * go back to it when the response ends; routers that could not be inlined run as
+ * nested levels of the same pipeline.
+ */
 class Pipeline {
 private:
+    friend class NextObject;
+    friend class PipelinePool;
     friend class Router;
 
-    Pipeline(
-        std::shared_ptr<Request> request,
-        std::shared_ptr<Response> response,
-        std::shared_ptr<std::vector<MiddlewareConfig>> middlewareList,
-        v8::Isolate* isolate
-    );
+    struct Level {
+        std::shared_ptr<const RouteTable> routeTable{nullptr};
+        // Captures are views into matchPath, which is not changed while the level is entered
+        std::string matchPath;
+        std::vector<RouteMatch> matches;
+        std::vector<std::string_view> captures;
+        // Index into matches and the registration index of the last emitted route
+        size_t current = 0;
+        size_t lastEmitted = SIZE_MAX;
+    };
+
+    explicit Pipeline(v8::Isolate* isolate);
 
-    Pipeline(
+    static void start(
         std::shared_ptr<Request> request,
         std::shared_ptr<Response> response,
-        std::shared_ptr<std::vector<MiddlewareConfig>> middlewareList,
-        NextObject* next,
+        std::shared_ptr<const RouteTable> routeTable,
         v8::Isolate* isolate
     );
 
-    void execute();
-    void eliminate();
-    void setNextObject();
+    void enter(std::shared_ptr<const RouteTable> routeTable, const std::string& path);
+    void branch(std::shared_ptr<const RouteTable> routeTable);
+    void leave();
+    void release();
+
+    void next();
+    void nextRoute();
+    void error(const std::string& err);
+    void finish(uint32_t status);
+
     std::shared_ptr<AbstractMiddleware> getNext(bool nextRoute = false);
     std::shared_ptr<AbstractMiddleware> getNextErrorHandling();
     [[nodiscard]] bool isValid() const;
+    [[nodiscard]] bool apply(Level& level, const RouteMatch& match);
+    [[nodiscard]] bool findMatch(Level& level, size_t end);
+    void emit(const std::shared_ptr<AbstractMiddleware>& middleware);
 
-    NextObject next;
-    NextObject* baseNext = nullptr;
-
-    std::function<void()> eliminateCallback;
-    std::function<void()>* baseEliminateCallback = nullptr;
+    NextObject nextObject;
+    std::function<void()> endCallback;
 
-    size_t current = 0;
-    bool isBase;
+    // Levels are kept between requests, a deque does not move the entered ones
+    std::deque<Level> levels;
+    size_t depth = 0;
+    std::vector<PlainMiddleware*> chain;
     bool isHandled = false;
 
-    std::shared_ptr<Request> req;
-    std::shared_ptr<Response> res;
-    std::shared_ptr<std::vector<MiddlewareConfig>> middlewareList;
-
-    v8::Isolate* isolate;
+    std::shared_ptr<Request> req{nullptr};
+    std::shared_ptr<Response> res{nullptr};
+    std::shared_ptr<LoopContext> context{nullptr};
 };
 
 
@@ -0,0 +1,427 @@
+#include "staticFileCache.h"
+
+#include <cinttypes>
+
+namespace nex {
+
+    namespace {
+        constexpr std::pair<std::string_view, ContentCoding> precompressedSuffixes[] = {
+            {".br", ContentCoding::Brotli},
+            {".gz", ContentCoding::Gzip}
+        };
+
+        constexpr std::pair<std::string_view, std::string_view> contentTypes[] = {
+            {"css", "text/css; charset=utf-8"},
+            {"csv", "text/csv; charset=utf-8"},
+            {"gif", "image/gif"},
+            {"htm", "text/html; charset=utf-8"},
+            {"html", "text/html; charset=utf-8"},
+            {"ico", "image/x-icon"},
+            {"jpeg", "image/jpeg"},
+            {"jpg", "image/jpeg"},
+            {"js", "application/javascript; charset=utf-8"},
+            {"json", "application/json; charset=utf-8"},
+            {"map", "application/json; charset=utf-8"},
+            {"mjs", "application/javascript; charset=utf-8"},
+            {"mp3", "audio/mpeg"},
+            {"mp4", "video/mp4"},
+            {"ogg", "audio/ogg"},
+            {"otf", "font/otf"},
+            {"pdf", "application/pdf"},
+            {"png", "image/png"},
+            {"svg", "image/svg+xml; charset=utf-8"},
+            {"ttf", "font/ttf"},
+            {"txt", "text/plain; charset=utf-8"},
+            {"wasm", "application/wasm"},
+            {"webm", "video/webm"},
+            {"webmanifest", "application/manifest+json; charset=utf-8"},
+            {"webp", "image/webp"},
+            {"woff", "font/woff"},
+            {"woff2", "font/woff2"},
+            {"xml", "application/xml; charset=utf-8"},
+            {"zip", "application/zip"}
+        };
+
+        constexpr std::string_view defaultContentType = "application/octet-stream";
+
+        bool statPath(const std::string& path, uv_stat_t& result) noexcept {
+            uv_fs_t req;
+            auto err = uv_fs_stat(nullptr, &req, path.c_str(), nullptr);
+
+            if (!err) {
+                result = req.statbuf;
+            }
+
+            uv_fs_req_cleanup(&req);
+
+            return !err;
+        }
+
+        bool isRegularFile(const uv_stat_t& stat) noexcept {
+            return (stat.st_mode & S_IFMT) == S_IFREG;
+        }
+
+        /**
+         * Opens a file and reads it into memory when it is small enough
+         */
+        bool openVariant(
+            const std::string& path,
+            uint64_t size,
+            uint64_t maxMemoryFileSize,
+            StaticFileVariant& variant
+        ) {
+            uv_fs_t req;
+            auto fd = uv_fs_open(nullptr, &req, path.c_str(), UV_FS_O_RDONLY, 0, nullptr);
+
+            uv_fs_req_cleanup(&req);
+
+            if (fd < 0) {
+                return false;
+            }
+
+            auto descriptor = std::make_shared<FileDescriptor>(static_cast<uv_file>(fd));
+
+            variant.size = size;
+
+            if (size > maxMemoryFileSize) {
+                variant.file = std::move(descriptor);
+                return true;
+            }
+
+            auto contents = std::make_shared<std::string>(static_cast<size_t>(size), '\0');
+            uint64_t offset = 0;
+
+            while (offset < size) {
+                auto buf = uv_buf_init(
+                    contents->data() + offset,
+                    static_cast<unsigned int>(size - offset)
+                );
+                auto bytesRead = uv_fs_read(
+                    nullptr, &req, descriptor->get(), &buf, 1, static_cast<int64_t>(offset), nullptr
+                );
+
+                uv_fs_req_cleanup(&req);
+
+                // Shrunk while being read, the watcher drops the entry anyway
+                if (bytesRead <= 0) {
+                    return false;
+                }
+
+                offset += static_cast<uint64_t>(bytesRead);
+            }
+
+            variant.contents = std::move(contents);
+
+            return true;
+        }
+
+        /**
+         * Variants of a file are told apart by their coding even if size and time happen to match
+         */
+        std::string getEtag(const uv_stat_t& stat, ContentCoding coding) {
+            auto modifiedAtMs = static_cast<uint64_t>(stat.st_mtim.tv_sec) * 1000 + stat.st_mtim.tv_nsec / 1000000;
+            char etag[48];
+
+            if (coding == ContentCoding::Identity) {
+                snprintf(etag, sizeof(etag), "\"%" PRIx64 "-%" PRIx64 "\"", stat.st_size, modifiedAtMs);
+            } else {
+                snprintf(
+                    etag, sizeof(etag), "\"%" PRIx64 "-%" PRIx64 "-%s\"",
+                    stat.st_size, modifiedAtMs, getCodingName(coding).data()
+                );
+            }
+
+            return etag;
+        }
+
+        std::string getDirectory(const std::string& path) {
+            auto separator = path.rfind('/');
+
+            if (separator == std::string::npos) {
+                return ".";
+            }
+
+            return separator ? path.substr(0, separator) : "/";
+        }
+    }
+
+    // StaticFile
+
+    const StaticFileVariant* StaticFile::findVariant(ContentCoding coding) const noexcept {
+        for (const auto& variant : variants) {
+            if (variant.coding == coding) {
+                return &variant;
+            }
+        }
+
+        return nullptr;
+    }
+
+    size_t StaticFile::getMemorySize() const noexcept {
+        size_t size = 0;
+
+        for (const auto& variant : variants) {
+            if (variant.contents) {
+                size += variant.contents->size();
+            }
+        }
+
+        return size;
+    }
+
+    size_t StaticFile::getOpenFileCount() const noexcept {
+        size_t count = 0;
+
+        for (const auto& variant : variants) {
+            if (variant.file) {
+                ++count;
+            }
+        }
+
+        return count;
+    }
+
+    // StaticFileCache
+
+    StaticFileCache::StaticFileCache(std::shared_ptr<uvw::Loop> eventLoop, size_t maxOpenFiles)
+        : loop(std::move(eventLoop)), maxOpenFiles(maxOpenFiles) {}
+
+    StaticFileCache::~StaticFileCache() {
+        for (auto& [directory, watcher] : watchers) {
+            watcher->clear();
+            watcher->close();
+        }
+    }
+
+    std::shared_ptr<const StaticFile> StaticFileCache::find(const std::string& path) const {
+        auto entry = entries.find(path);
+
+        return entry != entries.end() ? entry->second.file : nullptr;
+    }
+
+    void StaticFileCache::load(const std::string& path, const StaticFileLoadOptions& options, LoadCallback callback) {
+        // Requests for a file that is being loaded wait for the same load
+        auto pending = pendingLoads.find(path);
+
+        if (pending != pendingLoads.end()) {
+            pending->second.push_back(std::move(callback));
+            return;
+        }
+
+        pendingLoads[path].push_back(std::move(callback));
+
+        auto startedAt = generation;
+        auto result = std::make_shared<std::shared_ptr<StaticFile>>(nullptr);
+        auto work = loop->resource<uvw::WorkReq>([path, options, result]() {
+            *result = read(path, options);
+        });
+
+        work->once<uvw::WorkEvent>([this, path, result, startedAt](const uvw::WorkEvent&, uvw::WorkReq&) {
+            // Rendered on the loop, read() runs on the threadpool next to the loop's own date rendering
+            if (*result && !(*result)->isDirectory) {
+                (*result)->lastModified = getStandardizedTime((*result)->modifiedAt);
+            }
+
+            complete(path, std::move(*result), startedAt);
+        });
+
+        work->once<uvw::ErrorEvent>([this, path, startedAt](const uvw::ErrorEvent&, uvw::WorkReq&) {
+            complete(path, nullptr, startedAt);
+        });
+
+        work->queue();
+    }
+
+    std::shared_ptr<StaticFile> StaticFileCache::read(const std::string& path, const StaticFileLoadOptions& options) {
+        uv_stat_t stat;
+
+        if (!statPath(path, stat)) {
+            return nullptr;
+        }
+
+        auto file = std::make_shared<StaticFile>();
+
+        file->path = path;
+
+        if ((stat.st_mode & S_IFMT) == S_IFDIR) {
+            file->isDirectory = true;
+            return file;
+        }
+
+        if (!isRegularFile(stat)) {
+            return nullptr;
+        }
+
+        file->modifiedAt = static_cast<time_t>(stat.st_mtim.tv_sec);
+        file->contentType = std::string(getContentType(path));
+
+        StaticFileVariant identity;
+
+        identity.etag = getEtag(stat, ContentCoding::Identity);
+
+        if (!openVariant(path, stat.st_size, options.maxMemoryFileSize, identity)) {
+            return nullptr;
+        }
+
+        file->variants.push_back(std::move(identity));
+
+        if (!options.precompressed) {
+            return file;
+        }
+
+        for (const auto& [suffix, coding] : precompressedSuffixes) {
+            auto siblingPath = path + std::string(suffix);
+            uv_stat_t siblingStat;
+
+            // A sibling older than the file is a leftover of a previous build
+            if (
+                !statPath(siblingPath, siblingStat)
+                || !isRegularFile(siblingStat)
+                || siblingStat.st_mtim.tv_sec < stat.st_mtim.tv_sec
+            ) {
+                continue;
+            }
+
+            StaticFileVariant variant;
+
+            variant.coding = coding;
+            variant.etag = getEtag(siblingStat, coding);
+
+            if (openVariant(siblingPath, siblingStat.st_size, options.maxMemoryFileSize, variant)) {
+                file->variants.push_back(std::move(variant));
+            }
+        }
+
+        return file;
+    }
+
+    void StaticFileCache::complete(const std::string& path, std::shared_ptr<const StaticFile> file, uint64_t startedAt) {
+        if (file && startedAt == generation) {
+            insert(file);
+            watch(getDirectory(path));
+        }
+
+        auto pending = pendingLoads.find(path);
+
+        if (pending == pendingLoads.end()) {
+            return;
+        }
+
+        auto callbacks = std::move(pending->second);
+
+        pendingLoads.erase(pending);
+
+        for (auto& callback : callbacks) {
+            callback(file);
+        }
+    }
+
+    void StaticFileCache::insert(const std::shared_ptr<const StaticFile>& file) {
+        erase(file->path);
+
+        insertionOrder.push_back(file->path);
+        entries[file->path] = Entry{file, std::prev(insertionOrder.end())};
+        memorySize += file->getMemorySize();
+        openFiles += file->getOpenFileCount();
+
+        while (
+            (entries.size() > maxEntries || memorySize > maxMemorySize || openFiles > maxOpenFiles)
+            && entries.size() > 1
+        ) {
+            erase(insertionOrder.front());
+        }
+    }
+
+    void StaticFileCache::erase(const std::string& path) {
+        auto entry = entries.find(path);
+
+        if (entry == entries.end()) {
+            return;
+        }
+
+        memorySize -= entry->second.file->getMemorySize();
+        openFiles -= entry->second.file->getOpenFileCount();
+        insertionOrder.erase(entry->second.order);
+        entries.erase(entry);
+    }
+
+    void StaticFileCache::watch(const std::string& directory) {
+        if (watchers.find(directory) != watchers.end()) {
+            return;
+        }
+
+        auto watcher = loop->resource<uvw::FsEventHandle>();
+
+        if (!watcher) {
+            return;
+        }
+
+        watcher->on<uvw::FsEventEvent>([this, directory](const uvw::FsEventEvent& event, uvw::FsEventHandle&) {
+            invalidate(directory, event.filename ? event.filename : "");
+        });
+
+        // The directory itself is gone or can't be watched anymore
+        watcher->on<uvw::ErrorEvent>([this, directory](const uvw::ErrorEvent&, uvw::FsEventHandle& handle) {
+            invalidate(directory, "");
+            handle.clear();
+            handle.close();
+            watchers.erase(directory);
+        });
+
+        watcher->start(directory);
+
+        // Watching must not keep the loop alive
+        watcher->unreference();
+        watchers[directory] = std::move(watcher);
+    }
+
+    void StaticFileCache::invalidate(const std::string& directory, std::string_view name) {
+        ++generation;
+
+        if (name.empty()) {
+            auto prefix = directory == "/" ? directory : directory + "/";
+
+            for (auto it = entries.begin(); it != entries.end();) {
+                auto next = std::next(it);
+
+                if (it->first.compare(0, prefix.size(), prefix) == 0) {
+                    erase(it->first);
+                }
+
+                it = next;
+            }
+
+            return;
+        }
+
+        auto path = directory == "/" ? "/" + std::string(name) : directory + "/" + std::string(name);
+
+        erase(path);
+
+        for (const auto& [suffix, coding] : precompressedSuffixes) {
+            if (path.size() > suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                erase(path.substr(0, path.size() - suffix.size()));
+            }
+        }
+    }
+
+    std::string_view StaticFileCache::getContentType(std::string_view path) noexcept {
+        auto dot = path.rfind('.');
+        auto separator = path.rfind('/');
+
+        if (dot == std::string_view::npos || (separator != std::string_view::npos && dot < separator)) {
+            return defaultContentType;
+        }
+
+        auto extension = path.substr(dot + 1);
+
+        for (const auto& [knownExtension, contentType] : contentTypes) {
+            if (equalsCaseInsensitive(extension, knownExtension)) {
+                return contentType;
+            }
+        }
+
+        return defaultContentType;
+    }
+
+}
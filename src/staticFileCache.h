@@ -0,0 +1,105 @@
+#pragma once
+
+#include <uvw.hpp>
+
+#include "commonHeaders.h"
+#include "bodyEncoder.h"
+#include "fileSender.h"
+
+namespace nex {
+
+/**
+ * One representation of a static file, the file itself or a precompressed sibling of it
+ */
+struct StaticFileVariant {
+    ContentCoding coding = ContentCoding::Identity;
+    uint64_t size = 0;
+    // Strong, of the size and modification time of this variant, so that ranges can be validated with it
+    std::string etag;
+    // Small files are kept in memory, larger ones are sent from a descriptor kept open
+    std::shared_ptr<const std::string> contents{nullptr};
+    std::shared_ptr<const FileDescriptor> file{nullptr};
+};
+
+struct StaticFile {
+    std::string path;
+    std::string contentType;
+    std::string lastModified;
+    time_t modifiedAt = 0;
+    bool isDirectory = false;
+    // The identity variant comes first
+    std::vector<StaticFileVariant> variants;
+
+    [[nodiscard]] const StaticFileVariant* findVariant(ContentCoding coding) const noexcept;
+    [[nodiscard]] size_t getMemorySize() const noexcept;
+    [[nodiscard]] size_t getOpenFileCount() const noexcept;
+};
+
+struct StaticFileLoadOptions {
+    uint64_t maxMemoryFileSize = 64 * 1024;
+    // Look for `.br` and `.gz` siblings
+    bool precompressed = true;
+};
+
+/**
+ * Metadata, descriptors and contents of static files served by one event loop.
+ *
+ * Files are stat'ed, opened and read on the libuv threadpool, the loop only serves
+ * what is cached. The directories of cached files are watched and any change to a
+ * file drops its entry, the next request loads it again.
+ */
+class StaticFileCache {
+public:
+    typedef std::function<void(std::shared_ptr<const StaticFile>)> LoadCallback;
+
+    StaticFileCache(std::shared_ptr<uvw::Loop> loop, size_t maxOpenFiles);
+    StaticFileCache(const StaticFileCache&) = delete;
+    StaticFileCache& operator=(const StaticFileCache&) = delete;
+    ~StaticFileCache();
+
+    [[nodiscard]] std::shared_ptr<const StaticFile> find(const std::string& path) const;
+
+    /**
+     * Loads and caches a file, calls back with null when there's nothing at the path
+     */
+    void load(const std::string& path, const StaticFileLoadOptions& options, LoadCallback callback);
+
+    /**
+     * Content type of a file name by its extension
+     */
+    [[nodiscard]] static std::string_view getContentType(std::string_view path) noexcept;
+
+private:
+    static constexpr size_t maxEntries = 4096;
+    static constexpr size_t maxMemorySize = 64 * 1024 * 1024;
+
+    struct Entry {
+        std::shared_ptr<const StaticFile> file;
+        std::list<std::string>::iterator order;
+    };
+
+    static std::shared_ptr<StaticFile> read(const std::string& path, const StaticFileLoadOptions& options);
+
+    void complete(const std::string& path, std::shared_ptr<const StaticFile> file, uint64_t startedAt);
+    void insert(const std::shared_ptr<const StaticFile>& file);
+    void erase(const std::string& path);
+    void watch(const std::string& directory);
+    void invalidate(const std::string& directory, std::string_view name);
+
+    std::shared_ptr<uvw::Loop> loop;
+
+    std::unordered_map<std::string, Entry> entries;
+    // Paths from the oldest entry on, those are evicted first
+    std::list<std::string> insertionOrder;
+    std::unordered_map<std::string, std::shared_ptr<uvw::FsEventHandle>> watchers;
+    std::unordered_map<std::string, std::vector<LoadCallback>> pendingLoads;
+
+    size_t memorySize = 0;
+    // Entries holding descriptors are evicted past this, sends in flight keep theirs until done
+    size_t maxOpenFiles;
+    size_t openFiles = 0;
+    // Bumped on every invalidation, loads started before one aren't cached
+    uint64_t generation = 0;
+};
+
+}
@@ -0,0 +1,455 @@
+#include "staticMiddleware.h"
+
+#include <cinttypes>
+
+namespace nex {
+
+    namespace {
+        // Larger files are sent from disk, the cache never holds more than that per file
+        constexpr uint64_t maxMemoryFileSizeLimit = 16 * 1024 * 1024;
+
+        int getHexValue(char c) noexcept {
+            if (c >= '0' && c <= '9') {
+                return c - '0';
+            }
+
+            if (c >= 'a' && c <= 'f') {
+                return c - 'a' + 10;
+            }
+
+            if (c >= 'A' && c <= 'F') {
+                return c - 'A' + 10;
+            }
+
+            return -1;
+        }
+
+        std::string_view stripWeakness(std::string_view etag) noexcept {
+            return etag.substr(0, 2) == "W/" ? etag.substr(2) : etag;
+        }
+
+        std::string createBoundary() {
+            static std::atomic<uint32_t> counter{0};
+            char boundary[48];
+
+            snprintf(boundary, sizeof(boundary), "nexpress-%016" PRIx64 "-%08x", uv_hrtime(), ++counter);
+
+            return boundary;
+        }
+
+        v8::Local<v8::Value> getOption(v8::Isolate* isolate, v8::Local<v8::Object> options, const char* name) {
+            auto context = isolate->GetCurrentContext();
+            auto key = v8::String::NewFromUtf8(isolate, name, v8::NewStringType::kInternalized).ToLocalChecked();
+            v8::Local<v8::Value> value;
+
+            if (!options->Get(context, key).ToLocal(&value)) {
+                return v8::Undefined(isolate);
+            }
+
+            return value;
+        }
+    }
+
+    StaticMiddleware::StaticMiddleware(StaticOptions staticOptions)
+        : options(std::move(staticOptions))
+    {
+        while (options.root.length() > 1 && options.root.back() == '/') {
+            options.root.pop_back();
+        }
+    }
+
+    void StaticMiddleware::emit(
+        std::shared_ptr<Request> req,
+        std::shared_ptr<Response> res,
+        NextObject& next
+    ) {
+        auto method = req->getHttpMethod();
+
+        if (method != GET && method != HEAD) {
+            if (options.fallthrough) {
+                next.next();
+                return;
+            }
+
+            res->setHeader("Allow", std::string("GET, HEAD"));
+            res->setStatus(405);
+            res->end();
+            return;
+        }
+
+        std::string path;
+
+        if (!decodePath(req->getRelativePath(), path)) {
+            res->setStatus(403);
+            res->end();
+            return;
+        }
+
+        if (isHidden(path)) {
+            notFound(res, next);
+            return;
+        }
+
+        if (path.back() == '/') {
+            if (options.index.empty()) {
+                notFound(res, next);
+                return;
+            }
+
+            path += options.index;
+        }
+
+        auto context = res->getLoopContext();
+
+        if (!context) {
+            res->end();
+            return;
+        }
+
+        auto& cache = context->getStaticFileCache();
+        auto fullPath = options.root + path;
+
+        if (auto file = cache.find(fullPath)) {
+            serve(file, req, res, next);
+            return;
+        }
+
+        cache.load(fullPath, options.load, [this, req, res, &next](std::shared_ptr<const StaticFile> file) {
+            // The connection went away while the file was loading
+            if (!res->isWritable()) {
+                res->end();
+                return;
+            }
+
+            serve(file, req, res, next);
+        });
+    }
+
+    void StaticMiddleware::serve(
+        const std::shared_ptr<const StaticFile>& file,
+        const std::shared_ptr<Request>& req,
+        const std::shared_ptr<Response>& res,
+        NextObject& next
+    ) const {
+        if (!file) {
+            notFound(res, next);
+            return;
+        }
+
+        if (file->isDirectory) {
+            if (options.index.empty()) {
+                notFound(res, next);
+                return;
+            }
+
+            // `//host` or `/\host` would send the browser to another site, the path starts with one slash
+            std::string_view path = req->getPath();
+            auto start = path.find_first_not_of("/\\");
+
+            path.remove_prefix(start == std::string_view::npos ? path.length() : start);
+            res->setHeader("Location", "/" + std::string(path) + "/" + req->getQueryString());
+            res->setStatus(301);
+            res->end();
+            return;
+        }
+
+        auto variant = &file->variants.front();
+        auto rangeHeader = req->getHttpMethod() == GET ? req->getHeaderView(KnownHeader::Range) : std::string_view();
+        auto rangeStatus = RangeParseStatus::Ignored;
+        std::vector<ByteRange> ranges;
+
+        // Ranges always address the file itself, a precompressed variant is only ever sent whole
+        if (!rangeHeader.empty() && isRangeFresh(*file, *variant, *req)) {
+            rangeStatus = parseRange(rangeHeader, variant->size, ranges);
+        }
+
+        if (file->variants.size() > 1) {
+            if (rangeStatus == RangeParseStatus::Ignored) {
+                auto acceptEncoding = req->getHeaderView(KnownHeader::AcceptEncoding);
+                auto coding = negotiateCoding(acceptEncoding, file->findVariant(ContentCoding::Brotli) != nullptr);
+
+                if (auto precompressed = file->findVariant(coding)) {
+                    variant = precompressed;
+                }
+            }
+
+            res->appendHeader("Vary", "Accept-Encoding");
+        }
+
+        res->setHeader("Content-Type", file->contentType);
+        res->setHeader("Cache-Control", "public, max-age=" + std::to_string(options.maxAge));
+        res->setHeader("Accept-Ranges", std::string("bytes"));
+
+        if (options.etag) {
+            res->setHeader("ETag", variant->etag);
+        }
+
+        if (options.lastModified) {
+            res->setHeader("Last-Modified", file->lastModified);
+        }
+
+        if (variant->coding != ContentCoding::Identity) {
+            res->setHeader("Content-Encoding", std::string(getCodingName(variant->coding)));
+        }
+
+        if (isNotModified(*file, *variant, *req)) {
+            res->setStatus(304);
+            res->sendHead(variant->size);
+            return;
+        }
+
+        if (rangeStatus == RangeParseStatus::Unsatisfiable) {
+            res->setHeader("Content-Range", "bytes */" + std::to_string(variant->size));
+            res->setStatus(416);
+            res->end();
+            return;
+        }
+
+        if (rangeStatus == RangeParseStatus::Satisfiable) {
+            sendRanges(*file, *variant, ranges, res);
+            return;
+        }
+
+        res->setStatus(200);
+
+        if (req->getHttpMethod() == HEAD) {
+            res->sendHead(variant->size);
+            return;
+        }
+
+        if (variant->contents) {
+            const auto& contents = variant->contents;
+
+            res->send(OutputChunk{contents->data(), contents->size(), contents});
+            return;
+        }
+
+        res->sendFile(variant->file, 0, variant->size);
+    }
+
+    void StaticMiddleware::sendRanges(
+        const StaticFile& file,
+        const StaticFileVariant& variant,
+        const std::vector<ByteRange>& ranges,
+        const std::shared_ptr<Response>& res
+    ) {
+        auto getSegment = [&variant](const ByteRange& range) {
+            if (!variant.contents) {
+                return FileSegment{variant.file, range.offset, range.length, OutputChunk()};
+            }
+
+            auto data = OutputChunk{variant.contents->data() + range.offset, range.length, variant.contents};
+
+            return FileSegment{nullptr, 0, 0, std::move(data)};
+        };
+
+        res->setStatus(206);
+
+        // Sent as segments even from memory, a range must not be compressed on the fly
+        if (ranges.size() == 1) {
+            res->setHeader("Content-Range", getContentRange(ranges.front(), variant.size));
+            res->sendSegments({getSegment(ranges.front())});
+            return;
+        }
+
+        auto boundary = createBoundary();
+        std::vector<FileSegment> segments;
+
+        segments.reserve(ranges.size() * 2 + 1);
+
+        for (const auto& range : ranges) {
+            auto partHeaders = (segments.empty() ? "--" : "\r\n--") + boundary
+                + "\r\nContent-Type: " + file.contentType
+                + "\r\nContent-Range: " + getContentRange(range, variant.size)
+                + "\r\n\r\n";
+
+            segments.push_back(FileSegment{nullptr, 0, 0, OutputChunk::take(std::move(partHeaders))});
+            segments.push_back(getSegment(range));
+        }
+
+        segments.push_back(FileSegment{nullptr, 0, 0, OutputChunk::take("\r\n--" + boundary + "--\r\n")});
+
+        res->setHeader("Content-Type", "multipart/byteranges; boundary=" + boundary);
+        res->sendSegments(std::move(segments));
+    }
+
+    bool StaticMiddleware::isRangeFresh(const StaticFile& file, const StaticFileVariant& variant, const Request& req) const {
+        auto ifRange = trim(req.getHeaderView(KnownHeader::IfRange));
+
+        if (ifRange.empty()) {
+            return true;
+        }
+
+        // An entity tag has to match strongly, a date exactly
+        if (ifRange.front() == '"' || ifRange.substr(0, 2) == "W/") {
+            return options.etag && ifRange == variant.etag;
+        }
+
+        time_t date;
+
+        return options.lastModified && parseStandardizedTime(ifRange, date) && date == file.modifiedAt;
+    }
+
+    bool StaticMiddleware::isNotModified(const StaticFile& file, const StaticFileVariant& variant, const Request& req) const {
+        auto ifNoneMatch = req.getHeaderView(KnownHeader::IfNoneMatch);
+
+        // If-None-Match takes precedence, If-Modified-Since is only looked at without it
+        if (!ifNoneMatch.empty()) {
+            return options.etag && matchesEtag(ifNoneMatch, variant.etag);
+        }
+
+        auto ifModifiedSince = req.getHeaderView(KnownHeader::IfModifiedSince);
+        time_t since;
+
+        if (!options.lastModified || ifModifiedSince.empty() || !parseStandardizedTime(ifModifiedSince, since)) {
+            return false;
+        }
+
+        return file.modifiedAt <= since;
+    }
+
+    void StaticMiddleware::notFound(const std::shared_ptr<Response>& res, NextObject& next) const {
+        if (options.fallthrough) {
+            next.next();
+            return;
+        }
+
+        res->setStatus(404);
+        res->end();
+    }
+
+    bool StaticMiddleware::decodePath(std::string_view path, std::string& decoded) {
+        decoded.clear();
+        decoded.reserve(path.length() + 1);
+
+        if (path.empty() || path.front() != '/') {
+            decoded.push_back('/');
+        }
+
+        for (size_t i = 0; i < path.length(); ++i) {
+            if (path[i] != '%') {
+                decoded.push_back(path[i]);
+                continue;
+            }
+
+            if (i + 2 >= path.length()) {
+                return false;
+            }
+
+            auto high = getHexValue(path[i + 1]);
+            auto low = getHexValue(path[i + 2]);
+
+            if (high < 0 || low < 0) {
+                return false;
+            }
+
+            decoded.push_back(static_cast<char>(high * 16 + low));
+            i += 2;
+        }
+
+        if (decoded.find('\0') != std::string::npos) {
+            return false;
+        }
+
+        // Dot segments could leave the root
+        size_t segmentStart = 0;
+
+        for (size_t i = 1; i <= decoded.length(); ++i) {
+            if (i < decoded.length() && decoded[i] != '/') {
+                continue;
+            }
+
+            auto segment = std::string_view(decoded).substr(segmentStart + 1, i - segmentStart - 1);
+
+            if (segment == "." || segment == "..") {
+                return false;
+            }
+
+            segmentStart = i;
+        }
+
+        return true;
+    }
+
+    bool StaticMiddleware::isHidden(std::string_view path) noexcept {
+        return path.find("/.") != std::string_view::npos;
+    }
+
+    bool StaticMiddleware::matchesEtag(std::string_view ifNoneMatch, std::string_view etag) noexcept {
+        while (!ifNoneMatch.empty()) {
+            auto end = ifNoneMatch.find(',');
+            auto candidate = trim(ifNoneMatch.substr(0, end));
+
+            ifNoneMatch = end == std::string_view::npos ? std::string_view() : ifNoneMatch.substr(end + 1);
+
+            // If-None-Match compares weakly
+            if (candidate == "*" || stripWeakness(candidate) == stripWeakness(etag)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void StaticMiddleware::NewInstance(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = args.GetIsolate();
+
+        if (args.Length() < 1 || !args[0]->IsString()) {
+            isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(
+                    isolate, "Static root must be a string", v8::NewStringType::kNormal).ToLocalChecked()));
+            return;
+        }
+
+        StaticOptions options;
+        v8::String::Utf8Value root(isolate, args[0]);
+
+        options.root = *root;
+
+        if (args.Length() > 1 && args[1]->IsObject()) {
+            auto optionsObject = args[1].As<v8::Object>();
+
+            auto index = getOption(isolate, optionsObject, "index");
+            auto maxAge = getOption(isolate, optionsObject, "maxAge");
+            auto maxMemoryFileSize = getOption(isolate, optionsObject, "maxMemoryFileSize");
+
+            if (index->IsString()) {
+                v8::String::Utf8Value indexValue(isolate, index);
+                options.index = *indexValue;
+            } else if (index->IsFalse()) {
+                options.index.clear();
+            }
+
+            if (maxAge->IsNumber() && maxAge.As<v8::Number>()->Value() >= 0) {
+                options.maxAge = static_cast<uint32_t>(maxAge.As<v8::Number>()->Value());
+            }
+
+            if (maxMemoryFileSize->IsNumber() && maxMemoryFileSize.As<v8::Number>()->Value() >= 0) {
+                options.load.maxMemoryFileSize = std::min(
+                    static_cast<uint64_t>(maxMemoryFileSize.As<v8::Number>()->Value()),
+                    maxMemoryFileSizeLimit
+                );
+            }
+
+            for (auto [name, target] : {
+                std::make_pair("etag", &options.etag),
+                std::make_pair("lastModified", &options.lastModified),
+                std::make_pair("fallthrough", &options.fallthrough),
+                std::make_pair("precompressed", &options.load.precompressed)
+            }) {
+                auto value = getOption(isolate, optionsObject, name);
+
+                if (value->IsBoolean()) {
+                    *target = value.As<v8::Boolean>()->Value();
+                }
+            }
+        }
+
+        v8::Local<v8::Object> instance;
+        auto middleware = std::make_shared<StaticMiddleware>(std::move(options));
+
+        if (NativeLoadedMiddlewareWrapper::FromMiddleware(isolate, middleware).ToLocal(&instance)) {
+            args.GetReturnValue().Set(instance);
+        }
+    }
+
+}
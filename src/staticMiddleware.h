@@ -0,0 +1,80 @@
+#pragma once
+
+#include <node.h>
+
+#include "commonHeaders.h"
+#include "byteRange.h"
+#include "middleware.h"
+#include "staticFileCache.h"
+
+namespace nex {
+
+struct StaticOptions {
+    std::string root;
+    // Served for directory paths, empty disables it
+    std::string index = "index.html";
+    uint32_t maxAge = 0;
+    StaticFileLoadOptions load;
+    bool etag = true;
+    bool lastModified = true;
+    // Missing files go on to the next middleware instead of a 404
+    bool fallthrough = true;
+};
+
+/**
+ * Serves files under a root directory from the static file cache of the event loop,
+ * without calling into JS.
+ */
+class StaticMiddleware final : public ApplicationMiddleware {
+public:
+    explicit StaticMiddleware(StaticOptions options);
+
+    bool requiresIsolate(HttpMethod, const std::string&) const final { return false; }
+
+    void emit(
+        std::shared_ptr<Request> req,
+        std::shared_ptr<Response> res,
+        NextObject& next
+    ) final;
+
+    /**
+     * `static(root, options)` of the JS API, returns a native middleware object
+     */
+    static void NewInstance(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+private:
+    /**
+     * Percent-decodes a request path, false for malformed ones and ones escaping the root
+     */
+    static bool decodePath(std::string_view path, std::string& decoded);
+
+    /**
+     * Whether a decoded path goes through a dotfile or a dot directory, those are never served
+     */
+    static bool isHidden(std::string_view path) noexcept;
+    static bool matchesEtag(std::string_view ifNoneMatch, std::string_view etag) noexcept;
+
+    void serve(
+        const std::shared_ptr<const StaticFile>& file,
+        const std::shared_ptr<Request>& req,
+        const std::shared_ptr<Response>& res,
+        NextObject& next
+    ) const;
+    static void sendRanges(
+        const StaticFile& file,
+        const StaticFileVariant& variant,
+        const std::vector<ByteRange>& ranges,
+        const std::shared_ptr<Response>& res
+    );
+    [[nodiscard]] bool isNotModified(const StaticFile& file, const StaticFileVariant& variant, const Request& req) const;
+
+    /**
+     * Whether If-Range, if any, still names the current file, ranges of another one are no use
+     */
+    [[nodiscard]] bool isRangeFresh(const StaticFile& file, const StaticFileVariant& variant, const Request& req) const;
+    void notFound(const std::shared_ptr<Response>& res, NextObject& next) const;
+
+    StaticOptions options;
+};
+
+}
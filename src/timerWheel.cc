@@ -0,0 +1,158 @@
+#include "timerWheel.h"
+
+namespace nex {
+
+    // TimerEntry
+
+    TimerEntry::TimerEntry(Callback callback, void* data) noexcept
+        : callback(callback), data(data) {}
+
+    TimerEntry::~TimerEntry() {
+        if (wheel) {
+            wheel->disarm(*this);
+        }
+    }
+
+    // TimerWheel
+
+    TimerWheel::TimerWheel(std::shared_ptr<uvw::Loop> eventLoop)
+        : loop(std::move(eventLoop))
+    {
+        processedTick = currentTick();
+    }
+
+    TimerWheel::~TimerWheel() {
+        for (auto& head : slots) {
+            while (head.next != &head) {
+                auto entry = static_cast<TimerEntry*>(head.next);
+
+                unlink(*entry);
+                entry->wheel = nullptr;
+            }
+        }
+
+        if (timerHandle) {
+            timerHandle->clear();
+            timerHandle->close();
+        }
+    }
+
+    void TimerWheel::arm(TimerEntry& entry, uint64_t timeout) {
+        // An entry is unlinked from the wheel that holds it, never left in two lists
+        if (entry.wheel) {
+            entry.wheel->disarm(entry);
+        }
+
+        if (!armedCount) {
+            // Ticks that passed while the wheel was idle have nothing to expire
+            processedTick = currentTick();
+        }
+
+        entry.wheel = this;
+        entry.expiresAt = processedTick + (timeout + tickDuration - 1) / tickDuration;
+        if (entry.expiresAt == processedTick) {
+            ++entry.expiresAt;
+        }
+
+        link(slots[entry.expiresAt % slotCount], entry);
+        ++armedCount;
+
+        start();
+    }
+
+    void TimerWheel::disarm(TimerEntry& entry) noexcept {
+        if (entry.wheel != this) {
+            return;
+        }
+
+        unlink(entry);
+        entry.wheel = nullptr;
+        --armedCount;
+    }
+
+    uint64_t TimerWheel::currentTick() const noexcept {
+        return loop->now().count() / tickDuration;
+    }
+
+    void TimerWheel::advance() {
+        auto now = currentTick();
+        auto ticks = std::min<uint64_t>(now - processedTick, slotCount);
+
+        for (uint64_t i = 1; i <= ticks; ++i) {
+            auto& head = slots[(processedTick + i) % slotCount];
+            TimerLink due;
+
+            // Detach the slot so that callbacks may freely arm and disarm entries
+            if (head.next != &head) {
+                due.next = head.next;
+                due.prev = head.prev;
+                due.next->prev = &due;
+                due.prev->next = &due;
+                head.next = head.prev = &head;
+            }
+
+            while (due.next != &due) {
+                auto entry = static_cast<TimerEntry*>(due.next);
+
+                unlink(*entry);
+
+                if (entry->expiresAt > now) {
+                    link(head, *entry);
+                    continue;
+                }
+
+                entry->wheel = nullptr;
+                --armedCount;
+                entry->callback(*entry);
+            }
+        }
+
+        processedTick = now;
+
+        if (!armedCount) {
+            stop();
+        }
+    }
+
+    void TimerWheel::start() {
+        if (active) {
+            return;
+        }
+
+        if (!timerHandle) {
+            timerHandle = loop->resource<uvw::TimerHandle>();
+            timerHandle->data(thisRef);
+            timerHandle->on<uvw::TimerEvent>(handleTick);
+        }
+
+        active = true;
+        timerHandle->start(Time(tickDuration), Time(tickDuration));
+    }
+
+    void TimerWheel::stop() {
+        if (!active) {
+            return;
+        }
+
+        active = false;
+        timerHandle->stop();
+    }
+
+    void TimerWheel::link(TimerLink& head, TimerLink& link) noexcept {
+        link.prev = head.prev;
+        link.next = &head;
+        head.prev->next = &link;
+        head.prev = &link;
+    }
+
+    void TimerWheel::unlink(TimerLink& link) noexcept {
+        link.prev->next = link.next;
+        link.next->prev = link.prev;
+        link.prev = link.next = &link;
+    }
+
+    void TimerWheel::handleTick(const uvw::TimerEvent&, uvw::TimerHandle& handle) {
+        handle.data<TimerWheel>()->advance();
+    }
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <uvw.hpp>
+
+#include "commonHeaders.h"
+
+namespace nex {
+
+class TimerWheel;
+
+struct TimerLink {
+    TimerLink* prev = this;
+    TimerLink* next = this;
+};
+
+/**
+ * Intrusive timer owned by its user, armed on a TimerWheel.
+ * An entry disarms itself on destruction.
+ */
+class TimerEntry final : private TimerLink {
+public:
+    typedef void(*Callback)(TimerEntry& entry);
+
+    TimerEntry(Callback callback, void* data) noexcept;
+    TimerEntry(const TimerEntry&) = delete;
+    TimerEntry& operator=(const TimerEntry&) = delete;
+    ~TimerEntry();
+
+    [[nodiscard]] bool isArmed() const noexcept { return wheel != nullptr; }
+
+    template<class T>
+    [[nodiscard]] T* getData() const noexcept { return static_cast<T*>(data); }
+
+private:
+    friend class TimerWheel;
+
+    TimerWheel* wheel = nullptr;
+    uint64_t expiresAt = 0;
+    Callback callback;
+    void* data;
+};
+
+/**
+ * Hashed timing wheel driven by a single libuv timer.
+ *
+ * Arming and disarming are O(1) list operations. The driving timer ticks only while
+ * entries are armed, so an idle wheel does not keep the loop alive.
+ */
+class TimerWheel {
+public:
+    static constexpr uint64_t tickDuration = 32;
+    static constexpr size_t slotCount = 256;
+
+    explicit TimerWheel(std::shared_ptr<uvw::Loop> loop);
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+    ~TimerWheel();
+
+    /**
+     * (Re)arms the entry to fire after `timeout` milliseconds
+     */
+    void arm(TimerEntry& entry, uint64_t timeout);
+    void disarm(TimerEntry& entry) noexcept;
+
+private:
+    typedef std::chrono::duration<uint64_t, std::milli> Time;
+
+    static void handleTick(const uvw::TimerEvent&, uvw::TimerHandle& handle);
+    static void link(TimerLink& head, TimerLink& link) noexcept;
+    static void unlink(TimerLink& link) noexcept;
+
+    [[nodiscard]] uint64_t currentTick() const noexcept;
+
+    void advance();
+    void start();
+    void stop();
+
+    std::shared_ptr<uvw::Loop> loop;
+    std::shared_ptr<uvw::TimerHandle> timerHandle{nullptr};
+    std::shared_ptr<TimerWheel> thisRef{this, noop<TimerWheel>};
+
+    std::array<TimerLink, slotCount> slots;
+
+    uint64_t processedTick = 0;
+    size_t armedCount = 0;
+    bool active = false;
+};
+
+}
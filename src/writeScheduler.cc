@@ -0,0 +1,95 @@
+#include "writeScheduler.h"
+#include "httpConnection.h"
+
+namespace nex {
+
+    WriteScheduler::WriteScheduler(std::shared_ptr<uvw::Loop> eventLoop)
+        : loop(std::move(eventLoop)) {}
+
+    WriteScheduler::~WriteScheduler() {
+        if (checkHandle) {
+            checkHandle->clear();
+            checkHandle->close();
+        }
+
+        if (idleHandle) {
+            idleHandle->close();
+        }
+    }
+
+    void WriteScheduler::schedule(HttpConnection* connection) {
+        if (connection->flushScheduled) {
+            return;
+        }
+
+        connection->flushScheduled = true;
+        pending.push_back(connection);
+
+        start();
+    }
+
+    void WriteScheduler::cancel(HttpConnection* connection) noexcept {
+        if (!connection->flushScheduled) {
+            return;
+        }
+
+        connection->flushScheduled = false;
+        pending.erase(std::remove(pending.begin(), pending.end(), connection), pending.end());
+        std::replace(flushing.begin(), flushing.end(), connection, static_cast<HttpConnection*>(nullptr));
+    }
+
+    void WriteScheduler::start() {
+        if (active) {
+            return;
+        }
+
+        if (!checkHandle) {
+            checkHandle = loop->resource<uvw::CheckHandle>();
+            checkHandle->data(thisRef);
+            checkHandle->on<uvw::CheckEvent>(handleCheck);
+
+            idleHandle = loop->resource<uvw::IdleHandle>();
+        }
+
+        active = true;
+        checkHandle->start();
+        idleHandle->start();
+    }
+
+    void WriteScheduler::stop() {
+        if (!active) {
+            return;
+        }
+
+        active = false;
+        checkHandle->stop();
+        idleHandle->stop();
+    }
+
+    void WriteScheduler::flushAll() {
+        // Flushing may schedule more output (e.g. a pipelined request finished synchronously)
+        while (!pending.empty()) {
+            flushing.swap(pending);
+
+            for (size_t i = 0; i < flushing.size(); ++i) {
+                auto connection = flushing[i];
+
+                if (!connection) {
+                    continue;
+                }
+
+                connection->flushScheduled = false;
+                connection->flush();
+            }
+
+            flushing.clear();
+        }
+
+        stop();
+    }
+
+    void WriteScheduler::handleCheck(const uvw::CheckEvent&, uvw::CheckHandle& handle) {
+        handle.data<WriteScheduler>()->flushAll();
+    }
+
+}
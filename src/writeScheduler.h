@@ -0,0 +1,46 @@
+#pragma once
+
+#include <uvw.hpp>
+
+#include "commonHeaders.h"
+
+namespace nex {
+
+class HttpConnection;
+
+/**
+ * Flushes corked connection output once per event loop iteration.
+ *
+ * Connections that produced output are flushed from a check handle, i.e. right after
+ * the I/O callbacks of the current iteration. An idle handle is kept active while
+ * anything is pending so that the loop does not block in poll before flushing.
+ */
+class WriteScheduler {
+public:
+    explicit WriteScheduler(std::shared_ptr<uvw::Loop> loop);
+    WriteScheduler(const WriteScheduler&) = delete;
+    WriteScheduler& operator=(const WriteScheduler&) = delete;
+    ~WriteScheduler();
+
+    void schedule(HttpConnection* connection);
+    void cancel(HttpConnection* connection) noexcept;
+
+private:
+    static void handleCheck(const uvw::CheckEvent&, uvw::CheckHandle& handle);
+
+    void flushAll();
+    void start();
+    void stop();
+
+    std::shared_ptr<uvw::Loop> loop;
+    std::shared_ptr<uvw::CheckHandle> checkHandle{nullptr};
+    std::shared_ptr<uvw::IdleHandle> idleHandle{nullptr};
+    std::shared_ptr<WriteScheduler> thisRef{this, noop<WriteScheduler>};
+
+    std::vector<HttpConnection*> pending;
+    std::vector<HttpConnection*> flushing;
+
+    bool active = false;
+};
+
+}